@@ -3,19 +3,16 @@
  *
  * This example demonstrates how to use the EE_FILE library
  * to store and retrieve data from EEPROM with validity tracking.
+ *
+ * Step 1: File types. This sketch uses the built-in enum in eefile.h
+ * (IIC_START, KAL_MAN, USER_SETTINGS), so it builds in the Arduino IDE as is.
+ * To use your own types, put the enum in a header and build with
+ * -DEEFILE_TYPES_HEADER='"eefile_types.h"' (see README, Quick Start).
  */
 
 #include <Arduino.h>
 #include <eefile.h>
 
-// Step 1: Define your file types
-typedef enum {
-    IIC_START = 0,   // I2C address storage
-    KAL_MAN,         // Kalman filter parameters
-    USER_SETTINGS,   // User configuration
-    END              // Must end with END
-} EEFileType;
-
 void setup() {
     Serial.begin(115200);
     delay(1000);
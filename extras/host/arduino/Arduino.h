@@ -0,0 +1,50 @@
+/**
+ * @file Arduino.h
+ * @brief 主机端最小 Arduino 接口：只提供库本身用到的部分，供 ee_format_test 在 PC 上编译设备代码
+ *
+ * millis() / micros() 由使用者定义（ee_format_test.cpp 中用模拟时钟）。
+ */
+
+#ifndef __EE_HOST_ARDUINO__
+#define __EE_HOST_ARDUINO__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// 库的调试输出，主机测试默认关闭（需要时编译加 "-DFILE_DEBUG(...)=printf(__VA_ARGS__),puts(\"\")"）
+#ifndef FILE_DEBUG
+#define FILE_DEBUG(...) ((void)0)
+#endif
+
+unsigned long millis(void);
+unsigned long micros(void);
+
+class Print
+{
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buf, size_t len)
+    {
+        for (size_t i = 0; i < len; i++) {
+            write(buf[i]);
+        }
+        return len;
+    }
+};
+
+class Stream : public Print
+{
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
+
+class HardwareSerial : public Stream
+{
+};
+
+#endif
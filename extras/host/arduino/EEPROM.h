@@ -0,0 +1,27 @@
+/**
+ * @file EEPROM.h
+ * @brief 主机端 EEPROM 替身：4 KB 内存数组，初始为擦除态
+ */
+
+#ifndef __EE_HOST_EEPROM__
+#define __EE_HOST_EEPROM__
+
+#include <stdint.h>
+#include <string.h>
+
+class EEPROMClass
+{
+  public:
+    uint8_t mem[4096];
+
+    EEPROMClass() { memset(mem, 0xFF, sizeof(mem)); }
+    void begin() {}
+    uint8_t read(int addr) { return mem[addr]; }
+    void write(int addr, uint8_t value) { mem[addr] = value; }
+    void update(int addr, uint8_t value) { mem[addr] = value; }
+    uint16_t length() { return sizeof(mem); }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1,150 @@
+/**
+ * @file ee_host_serial.h
+ * @brief 主机工具共用：EEFILE 协议帧解析/封装与 POSIX 串口
+ */
+
+#ifndef __EE_HOST_SERIAL__
+#define __EE_HOST_SERIAL__
+#include "eefile_proto.h"
+
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/select.h>
+
+#include <cstdio>
+#include <vector>
+
+// ============ 帧解析器 ============
+class FrameParser
+{
+  public:
+    uint8_t cmd;
+    std::vector<uint8_t> payload;
+
+    FrameParser() : state(0), len(0), crc(0), rxCrc(0) {}
+
+    // 输入一个字节，解析出完整且 CRC 正确的帧时返回 true
+    bool feed(uint8_t c)
+    {
+        switch (state) {
+        case 0:
+            if (c == EEP_SOF) { crc = 0xFFFF; payload.clear(); state = 1; }
+            return false;
+        case 1:
+            cmd = c; crc = eep_crc16_update(crc, c); state = 2;
+            return false;
+        case 2:
+            len = c; crc = eep_crc16_update(crc, c); state = 3;
+            return false;
+        case 3:
+            len |= (uint16_t)c << 8; crc = eep_crc16_update(crc, c);
+            if (len > (cmd == EEP_CMD_STATUS ? EEP_STATUS_MAX_SIZE : EEP_MAX_PAYLOAD)) { state = 0; return false; }
+            state = len ? 4 : 5;
+            return false;
+        case 4:
+            payload.push_back(c); crc = eep_crc16_update(crc, c);
+            if (payload.size() >= len) state = 5;
+            return false;
+        case 5:
+            rxCrc = c; state = 6;
+            return false;
+        default:
+            rxCrc |= (uint16_t)c << 8; state = 0;
+            if (rxCrc != crc) {
+                fprintf(stderr, "CRC error on cmd 0x%02X\n", cmd);
+                return false;
+            }
+            return true;
+        }
+    }
+
+  private:
+    int state;
+    uint16_t len;
+    uint16_t crc;
+    uint16_t rxCrc;
+};
+
+static inline std::vector<uint8_t> buildFrame(uint8_t cmd, const uint8_t* payload, uint16_t len)
+{
+    std::vector<uint8_t> f;
+    f.push_back(EEP_SOF);
+    f.push_back(cmd);
+    f.push_back((uint8_t)(len & 0xFF));
+    f.push_back((uint8_t)(len >> 8));
+    f.insert(f.end(), payload, payload + len);
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 1; i < f.size(); i++) {
+        crc = eep_crc16_update(crc, f[i]);
+    }
+    f.push_back((uint8_t)(crc & 0xFF));
+    f.push_back((uint8_t)(crc >> 8));
+    return f;
+}
+
+static inline speed_t toSpeed(long baud)
+{
+    switch (baud) {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    default: return B0;
+    }
+}
+
+static inline int openSerial(const char* dev, long baud)
+{
+    int fd = open(dev, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        perror(dev);
+        return -1;
+    }
+    struct termios tio;
+    tcgetattr(fd, &tio);
+    cfmakeraw(&tio);
+    speed_t sp = toSpeed(baud);
+    if (sp == B0) {
+        fprintf(stderr, "unsupported baud %ld\n", baud);
+        close(fd);
+        return -1;
+    }
+    cfsetispeed(&tio, sp);
+    cfsetospeed(&tio, sp);
+    tcsetattr(fd, TCSANOW, &tio);
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+static inline bool writeAll(int fd, const std::vector<uint8_t>& buf)
+{
+    size_t off = 0;
+    while (off < buf.size()) {
+        ssize_t n = write(fd, buf.data() + off, buf.size() - off);
+        if (n <= 0) return false;
+        off += (size_t)n;
+    }
+    return true;
+}
+
+// 阻塞读取直到解析出一帧；超时返回 false
+static inline bool readFrame(int fd, FrameParser& parser, int timeoutMs)
+{
+    for (;;) {
+        fd_set rfds;
+        FD_ZERO(&rfds);
+        FD_SET(fd, &rfds);
+        struct timeval tv = { timeoutMs / 1000, (timeoutMs % 1000) * 1000 };
+        if (select(fd + 1, &rfds, NULL, NULL, &tv) <= 0) {
+            return false;
+        }
+        uint8_t c;
+        if (read(fd, &c, 1) == 1 && parser.feed(c)) {
+            return true;
+        }
+    }
+}
+
+#endif
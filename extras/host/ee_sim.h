@@ -0,0 +1,473 @@
+/**
+ * @file ee_sim.h
+ * @brief 主机端 EEFILE 存储模拟器：按器件代价模型与存储策略回放操作轨迹
+ *
+ * 模拟器不执行设备代码，而是按 eefile.cpp 的布局规则（[标记][数据]、
+ * 差分写、顺序分配地址）统计每个操作的耗时、编程字节数与每个单元的磨损，
+ * 用于比较不同策略与器件的延迟和寿命。
+ */
+
+#ifndef __EE_SIM__
+#define __EE_SIM__
+#include "ee_host_serial.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+// ============ 器件代价模型 ============
+typedef enum {
+    SIM_BYTE_EEPROM = 0,    // 片内 EEPROM：按字节擦写
+    SIM_PAGE_EEPROM,        // I2C/SPI EEPROM：按页编程，一次写周期覆盖整页
+    SIM_FLASH_EMU           // Flash 模拟 EEPROM：追加记录，页满时擦除
+} SimDeviceKind;
+
+struct SimDevice {
+    const char* name;
+    SimDeviceKind kind;
+    double readUs;          // 每字节读取耗时
+    double busUs;           // 每字节总线传输耗时（片内为 0）
+    double programUs;       // 一次编程耗时（字节 / 页 / 记录）
+    double eraseUs;         // 一次页擦除耗时（仅 Flash）
+    uint16_t pageSize;      // 页大小（字节）
+    uint32_t endurance;     // 单元（或页）擦写寿命
+};
+
+static const SimDevice SIM_DEVICES[] = {
+    { "avr",   SIM_BYTE_EEPROM, 0.5,  0.0,  3400.0, 0.0,     1,    100000 },
+    { "i2c",   SIM_PAGE_EEPROM, 25.0, 25.0, 5000.0, 0.0,     64,   1000000 },
+    { "flash", SIM_FLASH_EMU,   0.1,  0.0,  60.0,   25000.0, 1024, 10000 },
+};
+
+static inline const SimDevice* simFindDevice(const char* name)
+{
+    for (size_t i = 0; i < sizeof(SIM_DEVICES) / sizeof(SIM_DEVICES[0]); i++) {
+        if (strcmp(SIM_DEVICES[i].name, name) == 0) return &SIM_DEVICES[i];
+    }
+    return NULL;
+}
+
+// ============ 存储策略 ============
+// 取值与 eefile_proto.h 的 EEP_POLICY_* 一致
+typedef enum {
+    SIM_WRITE_THROUGH = EEP_POLICY_WRITE_THROUGH,   // 当前实现：每次 write 直接差分编程
+    SIM_WRITE_BACK = EEP_POLICY_WRITE_BACK,         // RAM 缓存，按 flushMs 周期回写
+    SIM_AB_ATOMIC = EEP_POLICY_AB_ATOMIC,           // 两份副本交替写 + 序号字节
+    SIM_LOG_STRUCTURED = EEP_POLICY_LOG,            // 区域内 slots 个槽位轮流追加
+    SIM_POLICY_COUNT
+} SimPolicyKind;
+
+static const char* const SIM_POLICY_NAMES[SIM_POLICY_COUNT] = {
+    "write-through", "write-back", "a/b-atomic", "log-structured"
+};
+
+struct SimPolicy {
+    SimPolicyKind kind;
+    uint32_t flushMs;       // write-back 回写周期
+    uint16_t slots;         // log-structured 槽位数
+};
+
+// ============ 轨迹 ============
+struct SimOp {
+    uint32_t t;             // 绝对时间（毫秒，从轨迹开始累计）
+    uint8_t op;             // EEP_OP_*（不含失败位）
+    uint8_t type;
+    uint16_t len;
+    bool failed;
+};
+
+/**
+ * 从文件读取 EEP_CMD_TRACE 帧（串口原样保存即可，其他帧会被忽略）
+ * @return 丢弃的记录总数（设备缓冲溢出），读取失败返回 -1
+ */
+static inline long simLoadTrace(const char* path, std::vector<SimOp>& ops)
+{
+    FILE* fp = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+    if (!fp) {
+        perror(path);
+        return -1;
+    }
+    FrameParser parser;
+    long dropped = 0;
+    uint32_t t = ops.empty() ? 0 : ops.back().t;
+    int c;
+    while ((c = fgetc(fp)) != EOF) {
+        if (!parser.feed((uint8_t)c) || parser.cmd != EEP_CMD_TRACE || parser.payload.size() < 2) {
+            continue;
+        }
+        const uint8_t* p = parser.payload.data();
+        size_t n = (parser.payload.size() - 2) / EEP_TRACE_RECORD_SIZE;
+        dropped += eep_get_u16(p);
+        p += 2;
+        for (size_t i = 0; i < n; i++, p += EEP_TRACE_RECORD_SIZE) {
+            SimOp o;
+            t += eep_get_u16(p);
+            o.t = t;
+            o.op = p[2] & (uint8_t)~EEP_OP_FAILED;
+            o.failed = (p[2] & EEP_OP_FAILED) != 0;
+            o.type = p[3];
+            o.len = eep_get_u16(p + 4);
+            ops.push_back(o);
+        }
+    }
+    if (fp != stdin) fclose(fp);
+    return dropped;
+}
+
+// ============ 模拟结果 ============
+struct SimReport {
+    uint32_t ops;
+    double totalUs;         // 调用方阻塞的总耗时
+    double maxOpUs;         // 单次操作最坏耗时
+    double backgroundUs;    // 后台回写耗时（write-back）
+    uint64_t bytesProgrammed;
+    uint64_t programOps;    // 编程次数（字节 / 页 / 记录）
+    uint64_t erases;        // 页擦除次数（Flash）
+    uint64_t hottest;       // 磨损最重单元（或页）的擦写次数
+    uint32_t footprint;     // 占用的存储空间
+    uint32_t ram;           // 策略额外占用的 RAM
+    double lifetimeDays;    // 以轨迹的速率推算的寿命
+};
+
+// ============ 模拟器 ============
+class EESim
+{
+  public:
+    struct File {
+        uint16_t maxSize;
+        uint16_t start;     // 策略展开后的起始地址
+        uint16_t span;      // 策略展开后的占用字节
+        uint16_t slot;      // 当前槽位（A/B、log）
+        bool valid;
+        bool dirty;         // write-back：RAM 中有未回写内容
+        uint32_t dirtySince;
+    };
+
+    /**
+     * @param sizes  每个文件类型的 maxSize（按注册顺序分配地址）
+     * @param change 每次 write 中实际变化字节的比例（差分写的效果，1.0 为最坏）
+     */
+    EESim(const SimDevice& dev, const SimPolicy& pol,
+          const std::map<uint8_t, uint16_t>& sizes, double change)
+        : device(dev), policy(pol), changeRatio(change), lastT(0), flashFill(0)
+    {
+        memset(&rep, 0, sizeof(rep));
+        uint32_t addr = 0;
+        for (std::map<uint8_t, uint16_t>::const_iterator it = sizes.begin(); it != sizes.end(); ++it) {
+            File f;
+            f.maxSize = it->second;
+            f.start = (uint16_t)addr;
+            f.span = (uint16_t)(copies() * (it->second + 1 + seqBytes()));
+            f.slot = 0;
+            f.valid = false;
+            f.dirty = false;
+            f.dirtySince = 0;
+            files[it->first] = f;
+            addr += f.span;
+            if (policy.kind == SIM_WRITE_BACK) rep.ram += it->second;
+        }
+        rep.footprint = addr;
+        wear.assign(device.kind == SIM_FLASH_EMU ? 2 : (addr ? addr : 1), 0);
+    }
+
+    void apply(const SimOp& o)
+    {
+        flushDue(o.t);
+        lastT = o.t;
+        rep.ops++;
+        if (o.failed) return;
+
+        std::map<uint8_t, File>::iterator it = files.find(o.type);
+        if (it == files.end()) return;
+        File& f = it->second;
+        double us = 0;
+
+        switch (o.op) {
+        case EEP_OP_WRITE: {
+            uint16_t changed = (uint16_t)ceil(changeRatio * o.len);
+            if (policy.kind == SIM_WRITE_BACK) {
+                us = o.len * 0.05;                  // 仅 RAM 拷贝
+                if (!f.dirty) f.dirtySince = o.t;
+                f.dirty = true;
+            } else {
+                us = program(f, changed, !f.valid);
+            }
+            f.valid = true;
+            break;
+        }
+        case EEP_OP_READ:
+            us = (policy.kind == SIM_WRITE_BACK) ? o.len * 0.05
+                                                 : (o.len + 1) * (device.readUs + device.busUs);
+            break;
+        case EEP_OP_ERASE:
+        case EEP_OP_SET_INVALID:
+            if (policy.kind == SIM_WRITE_BACK) f.dirty = false;
+            if (f.valid) us = programMarker(f);
+            f.valid = false;
+            break;
+        case EEP_OP_SET_VALID:
+            if (!f.valid) us = programMarker(f);
+            f.valid = true;
+            break;
+        case EEP_OP_IS_VALID:
+            us = device.readUs + device.busUs;
+            break;
+        }
+
+        rep.totalUs += us;
+        if (us > rep.maxOpUs) rep.maxOpUs = us;
+    }
+
+    SimReport finish()
+    {
+        flushDue(0xFFFFFFFFu);
+        for (size_t i = 0; i < wear.size(); i++) {
+            if (wear[i] > rep.hottest) rep.hottest = wear[i];
+        }
+        double days = lastT / 86400000.0;
+        if (rep.hottest == 0 || days <= 0) {
+            rep.lifetimeDays = INFINITY;
+        } else {
+            rep.lifetimeDays = device.endurance / (rep.hottest / days);
+        }
+        return rep;
+    }
+
+  private:
+    SimDevice device;
+    SimPolicy policy;
+    double changeRatio;
+    uint32_t lastT;
+    uint32_t flashFill;                 // Flash 模拟：活动页已用记录数
+    std::map<uint8_t, File> files;
+    std::vector<uint64_t> wear;
+    SimReport rep;
+
+    unsigned copies() const
+    {
+        switch (policy.kind) {
+        case SIM_AB_ATOMIC: return 2;
+        case SIM_LOG_STRUCTURED: return policy.slots ? policy.slots : 1;
+        default: return 1;
+        }
+    }
+
+    unsigned seqBytes() const
+    {
+        return (policy.kind == SIM_AB_ATOMIC || policy.kind == SIM_LOG_STRUCTURED) ? 1 : 0;
+    }
+
+    // 连续 n 字节编程需要的编程操作次数
+    uint32_t programCount(uint32_t addr, uint32_t n) const
+    {
+        if (n == 0) return 0;
+        if (device.kind == SIM_PAGE_EEPROM) {
+            return (uint32_t)((addr + n - 1) / device.pageSize - addr / device.pageSize + 1);
+        }
+        return n;
+    }
+
+    // 记录 n 字节的编程磨损，返回由此触发的页擦除次数
+    uint32_t touch(uint32_t addr, uint32_t n)
+    {
+        rep.bytesProgrammed += n;
+        if (device.kind == SIM_FLASH_EMU) {
+            // 每个字节写入为一条 4 字节记录，页满时搬移并擦除（两页轮换）
+            uint32_t perPage = device.pageSize / 4;
+            uint32_t erased = 0;
+            for (uint32_t i = 0; i < n; i++) {
+                if (++flashFill >= perPage) {
+                    flashFill = 0;
+                    rep.erases++;
+                    wear[rep.erases & 1]++;
+                    erased++;
+                }
+            }
+            return erased;
+        }
+        for (uint32_t i = 0; i < n && addr + i < wear.size(); i++) {
+            wear[addr + i]++;
+        }
+        return 0;
+    }
+
+    double programMarker(File& f)
+    {
+        uint32_t addr = f.start + f.slot * (f.maxSize + 1 + seqBytes());
+        uint32_t erased = touch(addr, 1);
+        rep.programOps++;
+        return device.busUs + device.programUs + erased * device.eraseUs;
+    }
+
+    // 写一次文件内容：changed 个数据字节 +（可能的）标记 + 序号
+    double program(File& f, uint16_t changed, bool markerChanges)
+    {
+        uint32_t slotSize = f.maxSize + 1 + seqBytes();
+        if (copies() > 1) {
+            f.slot = (uint16_t)((f.slot + 1) % copies());
+            // 换到新槽位后，旧内容不在该槽位，所有数据字节都需编程
+            changed = f.maxSize;
+            markerChanges = true;
+        }
+        uint32_t addr = f.start + f.slot * slotSize;
+        uint32_t n = changed + (markerChanges ? 1 : 0) + seqBytes();
+        uint32_t erased = touch(addr, n);   // 页满触发的擦除由本次写入承担
+
+        uint32_t programs = programCount(addr, n);
+        rep.programOps += programs;
+        return n * device.busUs + (f.maxSize + 1) * device.readUs
+             + programs * device.programUs + erased * device.eraseUs;
+    }
+
+    // write-back：到期的脏文件在后台整体回写
+    void flushDue(uint32_t now)
+    {
+        if (policy.kind != SIM_WRITE_BACK) return;
+        for (std::map<uint8_t, File>::iterator it = files.begin(); it != files.end(); ++it) {
+            File& f = it->second;
+            if (f.dirty && (now == 0xFFFFFFFFu || now - f.dirtySince >= policy.flushMs)) {
+                uint16_t changed = (uint16_t)ceil(changeRatio * f.maxSize);
+                rep.backgroundUs += program(f, changed, false);
+                f.dirty = false;
+            }
+        }
+    }
+};
+
+// ============ 最坏执行时间模型 ============
+#define SIM_CHUNK_SIZE      16      // updateBlock 的分块大小
+#define SIM_VBM_SLOTS       8       // EEFILE_VBM_SLOTS 默认值
+#define SIM_REMAP_SLOTS     4       // EEFILE_REMAP_SLOTS 默认值
+#define SIM_REMAP_ENTRY     7       // 重映射表项字节数
+
+// 与设备编译选项对应，ee_wcet 的命令行开关逐项设置
+struct SimWcetOptions {
+    bool hashConfirm;       // EEFILE_WRITE_HASH（HASH_CONFIRM 默认开）：哈希相同先整文件读回比较
+    bool verify;            // EEFILE_VERIFY：变化部分读回；按一次重映射计最坏情况
+    bool monotonic;         // EEFILE_MONOTONIC_MARKER：一次写入最多三次标记编程
+    bool validBitmap;       // EEFILE_VALID_BITMAP：标记换成一次位图槽提交
+    uint8_t copies;         // EEMirrorBackend 的副本数，1 表示不镜像
+};
+
+/**
+ * @brief updateBlock 写 n 个全部不同的字节的耗时（微秒）
+ *
+ * 逐 16 字节块先读后写。按页的器件（I2C，coalesceWrites()）每块合并成一次写，
+ * 跨页时两次写周期；其它器件每个字节一次编程。镜像时每个副本都写，读只读主副本。
+ */
+static inline double simBlockUs(const SimDevice& d, uint32_t n, const SimWcetOptions& o)
+{
+    double us = 0.0;
+    for (uint32_t off = 0; off < n; off += SIM_CHUNK_SIZE) {
+        uint32_t c = (n - off < SIM_CHUNK_SIZE) ? n - off : SIM_CHUNK_SIZE;
+        uint32_t programs = (d.kind == SIM_PAGE_EEPROM) ? (c + d.pageSize - 2) / d.pageSize + 1 : c;
+        us += c * (d.readUs + d.busUs);
+        us += o.copies * (c * d.busUs + programs * d.programUs);
+        if (o.verify) {
+            us += c * (d.readUs + d.busUs);
+        }
+    }
+    return us;
+}
+
+/**
+ * @brief 一次标记更新的耗时：programs 次单字节编程，或一次位图槽提交
+ *        （校验开启时坏槽换下一槽重写，最多 SIM_VBM_SLOTS - 1 次）
+ */
+static inline double simMarkerUs(const SimDevice& d, uint8_t programs, uint8_t maxFiles,
+    const SimWcetOptions& o)
+{
+    if (o.validBitmap) {
+        uint32_t slot = (maxFiles + 7) / 8 + 2;
+        return (o.verify ? SIM_VBM_SLOTS - 1 : 1) * simBlockUs(d, slot, o);
+    }
+    return (d.readUs + d.busUs) + programs * simBlockUs(d, 1, o);
+}
+
+/**
+ * @brief 按 eefile_impl.h 当前实现计算单次公共接口的最坏耗时（微秒）
+ *
+ * 计入：按类型直接下标查找；updateBlock 分块差分写和 I2C 按页合并（内容全部不同）；
+ * 哈希确认读；写后读回和一次坏区重映射（复制到备用区、追加表项、在新位置重写）；
+ * 单调标记（擦除态 + 写入中 + 有效）或位图槽提交；镜像副本的写入、首次访问的整区校验
+ * 和 flush 时每个副本各自重算 CRC；
+ * Flash 模拟一次写入最多一次页擦除。
+ * 不计入：存储策略、EELog / EEQueue / EETable、页式后端的记录搬移。
+ *
+ * @param op       EEP_OP_*
+ * @param maxSize  文件 maxSize（read 按读取 maxSize 字节计算）
+ * @param maxFiles 元数据表大小，决定位图槽长度
+ */
+static inline double simWorstCaseUs(const SimDevice& d, uint8_t op, uint16_t maxSize, uint8_t maxFiles,
+    const SimWcetOptions& o)
+{
+    const double lookupUs = 0.25;                     // fileIndex 直接下标
+    const double rd = d.readUs + d.busUs;
+    const double erase = (d.kind == SIM_FLASH_EMU) ? d.eraseUs : 0.0;
+    const uint32_t marker = o.validBitmap ? 0 : 1;
+    const uint32_t n = maxSize;
+    // 镜像：首次访问时每个副本整区读一遍算 CRC
+    const double mirrorCheck = (o.copies > 1) ? o.copies * (n + marker) * rd : 0.0;
+
+    switch (op) {
+    case EEP_OP_WRITE: {
+        double data = simBlockUs(d, n, o);
+        double mark = simMarkerUs(d, o.monotonic ? 3 : 1, maxFiles, o);
+        // 镜像：flush 时每个副本按自己的内容重算 CRC，与首次访问的校验同样是整区读取
+        double us = lookupUs + 2 * mirrorCheck + data + mark + erase;
+        if (o.hashConfirm) {
+            us += n * rd;
+        }
+        if (o.verify) {
+            // 读出旧内容复制到备用区，追加表项，再在新位置完整重写
+            us += (n + marker) * rd + simBlockUs(d, n + marker, o) +
+                  simBlockUs(d, SIM_REMAP_ENTRY, o) + data + mark;
+        }
+        return us;
+    }
+    case EEP_OP_READ:
+        return lookupUs + mirrorCheck + (n + marker) * rd;
+    case EEP_OP_ERASE:
+    case EEP_OP_SET_INVALID:
+        return lookupUs + mirrorCheck + simMarkerUs(d, 1, maxFiles, o) + erase;
+    case EEP_OP_SET_VALID:
+        // 单调标记从已失效出发：先回到擦除态再置有效
+        return lookupUs + mirrorCheck + simMarkerUs(d, o.monotonic ? 2 : 1, maxFiles, o) + erase;
+    case EEP_OP_IS_VALID:
+        return lookupUs + mirrorCheck + rd;
+    case EEP_OP_BEGIN: {
+        // Flash 模拟的 EEPROM.begin() 扫描有效页重建映射；位图槽每槽读两次（本槽和后继）
+        double us = (d.kind == SIM_FLASH_EMU) ? d.pageSize * d.readUs : 0.0;
+        if (o.validBitmap) {
+            us += 2.0 * SIM_VBM_SLOTS * ((maxFiles + 7) / 8 + 2) * rd;
+        }
+        if (o.verify) {
+            us += SIM_REMAP_SLOTS * SIM_REMAP_ENTRY * rd;
+        }
+        return us;
+    }
+    default:
+        return 0.0;
+    }
+}
+
+static const char* const SIM_OP_NAMES[EEP_OP_COUNT] = {
+    "-", "read", "write", "erase", "setValid", "setInvalid", "isValid", "begin"
+};
+
+/**
+ * @brief 从轨迹推断文件布局：maxSize 取读写过的最大长度（至少 1）
+ */
+static inline void simInferSizes(const std::vector<SimOp>& ops, std::map<uint8_t, uint16_t>& sizes)
+{
+    for (size_t i = 0; i < ops.size(); i++) {
+        uint16_t& s = sizes[ops[i].type];
+        if (ops[i].len > s) s = ops[i].len;
+        if (s == 0) s = 1;
+    }
+}
+
+#endif
@@ -0,0 +1,171 @@
+/**
+ * @file ee_status_decode.cpp
+ * @brief 主机端二进制状态解码：解析 EE_STATUS_BIN() / EEP_CMD_STATUS 输出
+ *
+ * 编译：g++ -std=c++11 -O2 -I../../src ee_status_decode.cpp -o ee_status_decode
+ * 用法：
+ *   ee_status_decode <文件|->  [--csv]          解析保存下来的帧（或裸负载）
+ *   ee_status_decode --tty <设备> <波特率> [--csv] [--interval 毫秒]
+ *                                               周期轮询设备（需 EEFILE_SYNC=1）
+ *
+ * --csv 每次输出一行：
+ *   时间戳,reads,writes,erases,bytesProgrammed,errors,validMask,markerWrites,markerSkips,
+ *   hashSkips,verifyFailures,remaps
+ * （旧版本状态没有的计数留空：版本 1 缺最后五列，版本 2 缺最后三列）
+ */
+
+#include "ee_host_serial.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+static bool decode(const uint8_t* p, size_t n, bool csv)
+{
+    if (n < EEP_STATUS_HEADER_SIZE_V1 || eep_get_u16(p) != EEP_STATUS_MAGIC) {
+        fprintf(stderr, "not an EEFILE status blob\n");
+        return false;
+    }
+    if (p[2] < 1 || p[2] > EEP_STATUS_VERSION) {
+        fprintf(stderr, "unsupported status version %u\n", p[2]);
+        return false;
+    }
+    uint8_t version = p[2];
+    size_t header = (version == 1) ? EEP_STATUS_HEADER_SIZE_V1 :
+                    (version == 2) ? EEP_STATUS_HEADER_SIZE_V2 : EEP_STATUS_HEADER_SIZE;
+    uint8_t count = p[4];
+    size_t need = header + EEP_STATUS_BITMAP_SIZE(count) + count * EEP_STATUS_FILE_SIZE;
+    if (n < need) {
+        fprintf(stderr, "truncated status (%zu < %zu)\n", n, need);
+        return false;
+    }
+
+    const uint8_t* bitmap = p + header;
+    const uint8_t* rec = bitmap + EEP_STATUS_BITMAP_SIZE(count);
+
+    if (csv) {
+        uint32_t mask = 0;
+        for (uint8_t i = 0; i < count && i < 32; i++) {
+            if (bitmap[i >> 3] & (1 << (i & 7))) mask |= 1UL << i;
+        }
+        printf("%ld,%u,%u,%u,%u,%u,0x%08X,", (long)time(NULL),
+            eep_get_u32(p + 10), eep_get_u32(p + 14), eep_get_u32(p + 18),
+            eep_get_u32(p + 22), eep_get_u16(p + 26), mask);
+        if (version == 1) {
+            printf(",");
+        } else {
+            printf("%u,%u", eep_get_u32(p + 28), eep_get_u32(p + 32));
+        }
+        if (version < 3) {
+            printf(",,,\n");
+        } else {
+            printf(",%u,%u,%u\n", eep_get_u32(p + 36), eep_get_u16(p + 40), eep_get_u16(p + 42));
+        }
+        fflush(stdout);
+        return true;
+    }
+
+    printf("EEFILE %s, %u/%u files, %u/%u bytes used\n",
+        (p[3] & EEP_STATUS_ENABLED) ? "enabled" : "disabled",
+        count, p[5], eep_get_u16(p + 8), eep_get_u16(p + 6));
+    printf("reads=%u writes=%u erases=%u programmed=%u errors=%u\n",
+        eep_get_u32(p + 10), eep_get_u32(p + 14), eep_get_u32(p + 18),
+        eep_get_u32(p + 22), eep_get_u16(p + 26));
+    if (version >= 2) {
+        printf("marker writes=%u skipped=%u\n", eep_get_u32(p + 28), eep_get_u32(p + 32));
+    }
+    if (version >= 3) {
+        printf("hash skips=%u verify failures=%u remaps=%u\n",
+            eep_get_u32(p + 36), eep_get_u16(p + 40), eep_get_u16(p + 42));
+    }
+    printf("%4s %6s %6s %6s %s\n", "type", "addr", "max", "len", "flags");
+    for (uint8_t i = 0; i < count; i++, rec += EEP_STATUS_FILE_SIZE) {
+        printf("%4u 0x%04X %6u %6u %c%c%c\n", rec[0],
+            eep_get_u16(rec + 2), eep_get_u16(rec + 4), eep_get_u16(rec + 6),
+            (rec[1] & EEP_STATUS_ENABLED) ? 'E' : 'D',
+            (rec[1] & EEP_STATUS_MODIFIED) ? 'M' : 'C',
+            (rec[1] & EEP_STATUS_VALID) ? 'V' : '-');
+    }
+    return true;
+}
+
+static int decodeStream(FILE* fp, bool csv)
+{
+    std::vector<uint8_t> data;
+    uint8_t buf[256];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) data.insert(data.end(), buf, buf + n);
+
+    // 优先按帧解析（可能连续保存了多帧），否则视为裸负载
+    FrameParser parser;
+    bool any = false;
+    for (size_t i = 0; i < data.size(); i++) {
+        if (parser.feed(data[i]) && parser.cmd == EEP_CMD_STATUS) {
+            any = decode(parser.payload.data(), parser.payload.size(), csv) || any;
+        }
+    }
+    if (!any && !data.empty()) {
+        any = decode(data.data(), data.size(), csv);
+    }
+    return any ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+    bool csv = false;
+    long intervalMs = 0;
+    const char* tty = NULL;
+    long baud = 0;
+    const char* path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--csv") == 0) {
+            csv = true;
+        } else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+            intervalMs = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--tty") == 0 && i + 2 < argc) {
+            tty = argv[++i];
+            baud = atol(argv[++i]);
+        } else {
+            path = argv[i];
+        }
+    }
+
+    if (!tty) {
+        if (!path) {
+            fprintf(stderr, "usage: %s <file|-> [--csv] | --tty <dev> <baud> [--csv] [--interval ms]\n", argv[0]);
+            return 2;
+        }
+        FILE* fp = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+        if (!fp) {
+            perror(path);
+            return 1;
+        }
+        return decodeStream(fp, csv);
+    }
+
+    int fd = openSerial(tty, baud);
+    if (fd < 0) return 1;
+
+    FrameParser parser;
+    do {
+        writeAll(fd, buildFrame(EEP_CMD_STATUS_REQ, NULL, 0));
+        bool got = false;
+        while (readFrame(fd, parser, 1000)) {
+            if (parser.cmd == EEP_CMD_STATUS) {
+                got = decode(parser.payload.data(), parser.payload.size(), csv);
+                break;
+            }
+        }
+        if (!got) {
+            fprintf(stderr, "no status reply\n");
+            if (!intervalMs) return 1;
+        }
+        if (intervalMs) usleep((useconds_t)intervalMs * 1000);
+    } while (intervalMs);
+
+    close(fd);
+    return 0;
+}
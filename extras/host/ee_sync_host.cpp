@@ -0,0 +1,105 @@
+/**
+ * @file ee_sync_host.cpp
+ * @brief 主机端增量同步工具：接收设备的 DELTA 帧并应用到本地 EEPROM 镜像
+ *
+ * 编译：g++ -std=c++11 -O2 -I../../src ee_sync_host.cpp -o ee_sync_host
+ * 用法：ee_sync_host <串口设备> <波特率> <镜像文件> [--full]
+ *
+ * 镜像文件是设备 EEFILE 区域的原始字节（[标记][数据]... 与设备一致）。
+ * 只有收到完整一批（帧数与 SYNC_END 一致）且镜像成功落盘后才回复 ACK，
+ * 否则设备会在下一次请求时重发本批区间。
+ */
+
+#include "ee_host_serial.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static bool saveImage(const std::string& path, const std::vector<uint8_t>& img)
+{
+    std::string tmp = path + ".tmp";
+    FILE* fp = fopen(tmp.c_str(), "wb");
+    if (!fp) return false;
+    bool ok = fwrite(img.data(), 1, img.size(), fp) == img.size();
+    ok = (fclose(fp) == 0) && ok;
+    return ok && rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 4) {
+        fprintf(stderr, "usage: %s <tty> <baud> <image.bin> [--full]\n", argv[0]);
+        return 2;
+    }
+    const char* dev = argv[1];
+    long baud = atol(argv[2]);
+    std::string imagePath = argv[3];
+    bool full = (argc > 4 && strcmp(argv[4], "--full") == 0);
+
+    // 读取已有镜像；不存在时必须做全量同步
+    std::vector<uint8_t> image;
+    FILE* fp = fopen(imagePath.c_str(), "rb");
+    if (fp) {
+        uint8_t buf[256];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) image.insert(image.end(), buf, buf + n);
+        fclose(fp);
+    } else {
+        full = true;
+    }
+
+    int fd = openSerial(dev, baud);
+    if (fd < 0) return 1;
+
+    if (!writeAll(fd, buildFrame(full ? EEP_CMD_SYNC_FULL : EEP_CMD_SYNC_REQ, NULL, 0))) {
+        perror("write");
+        return 1;
+    }
+
+    // 先收集在临时副本上，确认整批完整后再替换
+    std::vector<uint8_t> staged = image;
+    FrameParser parser;
+    unsigned deltas = 0, bytes = 0;
+
+    for (;;) {
+        if (!readFrame(fd, parser, 5000)) {
+            fprintf(stderr, "timeout after %u frames, batch not acknowledged\n", deltas);
+            return 1;
+        }
+        const std::vector<uint8_t>& p = parser.payload;
+
+        if (parser.cmd == EEP_CMD_DELTA && p.size() >= 2) {
+            uint16_t addr = eep_get_u16(&p[0]);
+            size_t len = p.size() - 2;
+            if (staged.size() < addr + len) staged.resize(addr + len, 0xFF);
+            memcpy(&staged[addr], &p[2], len);
+            deltas++;
+            bytes += (unsigned)len;
+        } else if (parser.cmd == EEP_CMD_SYNC_END && p.size() >= 6) {
+            uint16_t gen = eep_get_u16(&p[0]);
+            uint16_t frames = eep_get_u16(&p[2]);
+            uint16_t size = eep_get_u16(&p[4]);
+            if (frames != deltas) {
+                fprintf(stderr, "batch %u incomplete (%u/%u frames)\n", gen, deltas, frames);
+                return 1;
+            }
+            if (staged.size() < size) staged.resize(size, 0xFF);
+            if (!saveImage(imagePath, staged)) {
+                perror(imagePath.c_str());
+                return 1;
+            }
+            uint8_t ack[2];
+            eep_put_u16(ack, gen);
+            writeAll(fd, buildFrame(EEP_CMD_SYNC_ACK, ack, 2));
+            printf("batch %u: %u frames, %u bytes applied\n", gen, deltas, bytes);
+            close(fd);
+            return 0;
+        } else if (parser.cmd == EEP_CMD_NAK) {
+            fprintf(stderr, "device rejected command\n");
+            return 1;
+        }
+    }
+}
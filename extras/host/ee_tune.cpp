@@ -0,0 +1,240 @@
+/**
+ * @file ee_tune.cpp
+ * @brief 主机端策略自动选择：按轨迹统计每个文件的读写频率与大小，
+ *        在 RAM 与存储空间预算内为每个文件推荐磨损最小、写延迟最低的存储策略
+ *
+ * 编译：g++ -std=c++11 -O2 -I../../src ee_tune.cpp -o ee_tune
+ * 用法：ee_tune <轨迹文件|-> [选项]
+ *   --device avr|i2c|flash   器件代价模型（默认 avr）
+ *   --ram <字节>             可用于写缓存的 RAM 预算（默认 64）
+ *   --space <字节>           EEFILE 区域大小（默认 512，即 EEFILE_TOTAL_SIZE）
+ *   --life <年>              目标寿命（默认 10）
+ *   --change <0..1>          每次写入实际变化字节比例（默认 1.0）
+ *   --flush <毫秒>           write-back 回写周期（默认 1000）
+ *   --slots <n>              log-structured 槽位数（默认 4）
+ *   --emit <路径>            生成策略表头文件（EEP_POLICY_* 按文件类型索引）
+ *
+ * 选择过程：
+ *   1. 单独回放每个文件的操作，得到每种策略的寿命、阻塞时间、RAM 与空间
+ *   2. 不占 RAM 的策略中，优先满足寿命目标、再取阻塞时间最短者
+ *   3. 按“收益 / RAM”从高到低把文件升级为 write-back，直到 RAM 预算用完
+ *   4. 总空间超出时，把空间放大倍数最高的文件退回 write-through
+ */
+
+#include "ee_sim.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+struct Option {
+    SimReport r;
+    bool feasible;          // 是否满足寿命目标
+};
+
+struct FileStat {
+    uint8_t type;
+    uint16_t size;
+    uint32_t reads;
+    uint32_t writes;
+    const char* label;
+    Option opt[SIM_POLICY_COUNT];
+    int choice;
+};
+
+static const char* classify(const FileStat& f, double hours)
+{
+    if (f.writes == 0) return "read-only";
+    double perHour = hours > 0 ? f.writes / hours : f.writes;
+    if (perHour > 60) return "hot";
+    if (f.reads > 10 * f.writes) return "read-mostly";
+    if (f.writes <= 2) return "static";
+    return "warm";
+}
+
+// 比较两个选项：先看是否满足寿命，再看阻塞时间，最后看寿命
+static bool better(const Option& a, const Option& b)
+{
+    if (a.feasible != b.feasible) return a.feasible;
+    if (!a.feasible) return a.r.lifetimeDays > b.r.lifetimeDays;
+    if (a.r.totalUs != b.r.totalUs) return a.r.totalUs < b.r.totalUs;
+    return a.r.lifetimeDays > b.r.lifetimeDays;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <trace|-> [--device d] [--ram bytes] [--space bytes] [--life years] "
+                        "[--change r] [--flush ms] [--slots n] [--emit header]\n", argv[0]);
+        return 2;
+    }
+
+    const SimDevice* device = &SIM_DEVICES[0];
+    uint32_t ramBudget = 64, space = 512;
+    double lifeYears = 10, change = 1.0;
+    uint32_t flushMs = 1000;
+    uint16_t slots = 4;
+    const char* emit = NULL;
+
+    for (int i = 2; i < argc; i++) {
+        if (i + 1 >= argc) break;
+        if (strcmp(argv[i], "--device") == 0) {
+            device = simFindDevice(argv[++i]);
+            if (!device) {
+                fprintf(stderr, "unknown device %s\n", argv[i]);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--ram") == 0) {
+            ramBudget = (uint32_t)atol(argv[++i]);
+        } else if (strcmp(argv[i], "--space") == 0) {
+            space = (uint32_t)atol(argv[++i]);
+        } else if (strcmp(argv[i], "--life") == 0) {
+            lifeYears = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--change") == 0) {
+            change = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--flush") == 0) {
+            flushMs = (uint32_t)atol(argv[++i]);
+        } else if (strcmp(argv[i], "--slots") == 0) {
+            slots = (uint16_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--emit") == 0) {
+            emit = argv[++i];
+        }
+    }
+
+    std::vector<SimOp> ops;
+    if (simLoadTrace(argv[1], ops) < 0) return 1;
+    if (ops.empty()) {
+        fprintf(stderr, "no trace records found\n");
+        return 1;
+    }
+    std::map<uint8_t, uint16_t> sizes;
+    simInferSizes(ops, sizes);
+    double hours = ops.back().t / 3600000.0;
+
+    // ============ 1. 每个文件、每种策略单独回放 ============
+    std::vector<FileStat> stats;
+    for (std::map<uint8_t, uint16_t>::iterator it = sizes.begin(); it != sizes.end(); ++it) {
+        FileStat f;
+        memset(&f, 0, sizeof(f));
+        f.type = it->first;
+        f.size = it->second;
+
+        std::map<uint8_t, uint16_t> one;
+        one[f.type] = f.size;
+        for (int k = 0; k < SIM_POLICY_COUNT; k++) {
+            SimPolicy pol = { (SimPolicyKind)k, flushMs, slots };
+            EESim sim(*device, pol, one, change);
+            for (size_t i = 0; i < ops.size(); i++) {
+                if (ops[i].type != f.type) continue;
+                if (k == 0) {
+                    if (ops[i].op == EEP_OP_READ) f.reads++;
+                    if (ops[i].op == EEP_OP_WRITE) f.writes++;
+                }
+                sim.apply(ops[i]);
+            }
+            // 以整条轨迹的时长推算寿命，而不是该文件最后一次操作的时间
+            SimOp idle = { ops.back().t, 0, f.type, 0, false };
+            sim.apply(idle);
+            f.opt[k].r = sim.finish();
+            f.opt[k].feasible = f.opt[k].r.lifetimeDays >= lifeYears * 365.0;
+        }
+        f.label = classify(f, hours);
+        stats.push_back(f);
+    }
+
+    // ============ 2. 不占 RAM 的最优策略 ============
+    uint32_t ramUsed = 0, spaceUsed = 0;
+    for (size_t i = 0; i < stats.size(); i++) {
+        FileStat& f = stats[i];
+        f.choice = SIM_WRITE_THROUGH;
+        for (int k = 0; k < SIM_POLICY_COUNT; k++) {
+            if (k == SIM_WRITE_BACK) continue;
+            if (better(f.opt[k], f.opt[f.choice])) f.choice = k;
+        }
+    }
+
+    // ============ 3. 按收益 / RAM 分配写缓存 ============
+    std::vector<std::pair<double, size_t> > gains;
+    for (size_t i = 0; i < stats.size(); i++) {
+        const FileStat& f = stats[i];
+        const Option& wb = f.opt[SIM_WRITE_BACK];
+        if (!better(wb, f.opt[f.choice])) continue;
+        double gain = (f.opt[f.choice].r.totalUs - wb.r.totalUs)
+                    + (double)(f.opt[f.choice].r.hottest - std::min(f.opt[f.choice].r.hottest, wb.r.hottest)) * device->programUs;
+        gains.push_back(std::make_pair(gain / (wb.r.ram ? wb.r.ram : 1), i));
+    }
+    std::sort(gains.rbegin(), gains.rend());
+    for (size_t g = 0; g < gains.size(); g++) {
+        FileStat& f = stats[gains[g].second];
+        uint32_t need = f.opt[SIM_WRITE_BACK].r.ram;
+        if (ramUsed + need <= ramBudget) {
+            f.choice = SIM_WRITE_BACK;
+            ramUsed += need;
+        }
+    }
+
+    // ============ 4. 空间超出时退回 write-through ============
+    for (size_t i = 0; i < stats.size(); i++) spaceUsed += stats[i].opt[stats[i].choice].r.footprint;
+    while (spaceUsed > space) {
+        size_t worst = stats.size();
+        uint32_t worstExtra = 0;
+        for (size_t i = 0; i < stats.size(); i++) {
+            uint32_t extra = stats[i].opt[stats[i].choice].r.footprint - stats[i].opt[SIM_WRITE_THROUGH].r.footprint;
+            if (extra > worstExtra) {
+                worstExtra = extra;
+                worst = i;
+            }
+        }
+        if (worst == stats.size()) break;
+        stats[worst].choice = SIM_WRITE_THROUGH;
+        spaceUsed -= worstExtra;
+    }
+
+    // ============ 输出 ============
+    printf("trace: %zu ops over %.2f h, device %s, ram budget %u, space %u, target %.1f years\n",
+        ops.size(), hours, device->name, ramBudget, space, lifeYears);
+    printf("%4s %6s %8s %8s %-12s %-15s %12s %10s\n", "type", "size", "reads", "writes",
+        "class", "policy", "life(days)", "block(ms)");
+    for (size_t i = 0; i < stats.size(); i++) {
+        const FileStat& f = stats[i];
+        const SimReport& r = f.opt[f.choice].r;
+        printf("%4u %6u %8u %8u %-12s %-15s %12.4g %10.1f%s\n", f.type, f.size, f.reads, f.writes,
+            f.label, SIM_POLICY_NAMES[f.choice], r.lifetimeDays, r.totalUs / 1000.0,
+            f.opt[f.choice].feasible ? "" : "  (below target)");
+    }
+    printf("ram used %u / %u, space used %u / %u\n", ramUsed, ramBudget, spaceUsed, space);
+
+    if (emit) {
+        FILE* fp = fopen(emit, "w");
+        if (!fp) {
+            perror(emit);
+            return 1;
+        }
+        uint8_t maxType = sizes.rbegin()->first;
+        fprintf(fp, "// 由 ee_tune 生成（设备 %s，RAM 预算 %u 字节，目标寿命 %.1f 年）\n",
+            device->name, ramBudget, lifeYears);
+        fprintf(fp, "// 按文件类型索引的推荐策略，取值见 eefile_proto.h 的 EEP_POLICY_*\n");
+        fprintf(fp, "#ifndef __EE_POLICY_TABLE__\n#define __EE_POLICY_TABLE__\n");
+        fprintf(fp, "#include \"eefile_proto.h\"\n\n");
+        fprintf(fp, "#define EE_TUNED_FLUSH_MS %u\n", flushMs);
+        fprintf(fp, "#define EE_TUNED_LOG_SLOTS %u\n\n", slots);
+        fprintf(fp, "static const uint8_t EE_TUNED_POLICY[%u] = {\n", maxType + 1);
+        for (unsigned t = 0; t <= maxType; t++) {
+            const FileStat* f = NULL;
+            for (size_t i = 0; i < stats.size(); i++) {
+                if (stats[i].type == t) f = &stats[i];
+            }
+            if (!f) {
+                fprintf(fp, "    EEP_POLICY_NONE,\n");
+                continue;
+            }
+            static const char* const IDS[SIM_POLICY_COUNT] = {
+                "EEP_POLICY_WRITE_THROUGH", "EEP_POLICY_WRITE_BACK", "EEP_POLICY_AB_ATOMIC", "EEP_POLICY_LOG"
+            };
+            fprintf(fp, "    %s,  // type %u: %s, %u bytes\n", IDS[f->choice], t, f->label, f->size);
+        }
+        fprintf(fp, "};\n\n#endif\n");
+        fclose(fp);
+        printf("policy table written to %s\n", emit);
+    }
+    return 0;
+}
@@ -0,0 +1,144 @@
+/**
+ * @file ee_wcet.cpp
+ * @brief 最坏执行时间检查：按模拟器代价模型（或设备实测）给出每个公共接口、
+ *        每种配置的最坏耗时，超过设定上限时以非零状态退出（可接入 CI）
+ *
+ * 编译：g++ -std=c++11 -O2 -I../../src ee_wcet.cpp -o ee_wcet
+ * 用法：
+ *   ee_wcet [--device avr|i2c|flash|all] [--sizes 1,16,64] [--files n]
+ *           [--hash] [--verify] [--monotonic] [--bitmap] [--mirror n]
+ *           [--bound <接口>=<毫秒>]...
+ *       按代价模型计算（默认 all 器件、sizes=1,16,64,256、files=10）。
+ *       开关与设备的编译选项对应：--hash 为 EEFILE_WRITE_HASH（带确认读），
+ *       --verify 为 EEFILE_VERIFY，--monotonic 为 EEFILE_MONOTONIC_MARKER，
+ *       --bitmap 为 EEFILE_VALID_BITMAP，--mirror n 为 n 份镜像
+ *   ee_wcet --tty <设备> <波特率> --cycles-per-ms <n> [--bound <接口>=<毫秒>]...
+ *       读取设备 EEFILE_WCET 实测值（需 EEFILE_SYNC=1 与 EEFILE_WCET=1）
+ *
+ * 接口名：read write erase setValid setInvalid isValid begin
+ */
+
+#include "ee_sim.h"
+
+#include <cstdlib>
+#include <sstream>
+
+static int opByName(const char* name)
+{
+    for (int op = 1; op < EEP_OP_COUNT; op++) {
+        if (strcmp(SIM_OP_NAMES[op], name) == 0) return op;
+    }
+    return -1;
+}
+
+// 打印一行，超出上限返回 false
+static bool check(const char* config, int op, double ms, const double* bounds)
+{
+    bool over = bounds[op] > 0 && ms > bounds[op];
+    printf("%-22s %-10s %10.3f", config, SIM_OP_NAMES[op], ms);
+    if (bounds[op] > 0) {
+        printf(" %10.3f  %s", bounds[op], over ? "FAIL" : "ok");
+    }
+    printf("\n");
+    return !over;
+}
+
+int main(int argc, char** argv)
+{
+    const char* deviceName = "all";
+    std::vector<uint16_t> sizes;
+    uint8_t maxFiles = 10;
+    double bounds[EEP_OP_COUNT] = { 0 };
+    const char* tty = NULL;
+    long baud = 0;
+    double cyclesPerMs = 1000.0;      // 默认 EEFILE_CYCLES() = micros()
+    SimWcetOptions opt = { false, false, false, false, 1 };
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--device") == 0 && i + 1 < argc) {
+            deviceName = argv[++i];
+        } else if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+            std::stringstream ss(argv[++i]);
+            std::string item;
+            while (std::getline(ss, item, ',')) sizes.push_back((uint16_t)atoi(item.c_str()));
+        } else if (strcmp(argv[i], "--files") == 0 && i + 1 < argc) {
+            maxFiles = (uint8_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--hash") == 0) {
+            opt.hashConfirm = true;
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            opt.verify = true;
+        } else if (strcmp(argv[i], "--monotonic") == 0) {
+            opt.monotonic = true;
+        } else if (strcmp(argv[i], "--bitmap") == 0) {
+            opt.validBitmap = true;
+        } else if (strcmp(argv[i], "--mirror") == 0 && i + 1 < argc) {
+            opt.copies = (uint8_t)atoi(argv[++i]);
+            if (opt.copies < 1) opt.copies = 1;
+        } else if (strcmp(argv[i], "--bound") == 0 && i + 1 < argc) {
+            char name[32];
+            double ms;
+            if (sscanf(argv[++i], "%31[^=]=%lf", name, &ms) != 2 || opByName(name) < 0) {
+                fprintf(stderr, "bad bound %s\n", argv[i]);
+                return 2;
+            }
+            bounds[opByName(name)] = ms;
+        } else if (strcmp(argv[i], "--tty") == 0 && i + 2 < argc) {
+            tty = argv[++i];
+            baud = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--cycles-per-ms") == 0 && i + 1 < argc) {
+            cyclesPerMs = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    bool ok = true;
+    if (!tty) {
+        printf("model: 16-byte chunked diff writes, I2C page coalescing, all bytes changed\n");
+        printf("options: hash-confirm=%d verify+1 remap=%d monotonic=%d bitmap=%d mirror=%u\n",
+            opt.hashConfirm, opt.verify, opt.monotonic, opt.validBitmap, opt.copies);
+        printf("not modelled: storage policies, EELog/EEQueue/EETable, page backend transfer\n");
+    }
+    printf("%-22s %-10s %10s %10s\n", "config", "api", "worst(ms)", "bound(ms)");
+
+    // ============ 设备实测 ============
+    if (tty) {
+        int fd = openSerial(tty, baud);
+        if (fd < 0) return 1;
+        writeAll(fd, buildFrame(EEP_CMD_WCET_REQ, NULL, 0));
+        FrameParser parser;
+        while (readFrame(fd, parser, 2000)) {
+            if (parser.cmd != EEP_CMD_WCET || parser.payload.size() < EEP_WCET_SIZE) continue;
+            const uint8_t* p = parser.payload.data();
+            for (int op = 1; op < EEP_OP_COUNT; op++) {
+                double ms = eep_get_u32(p + 2 + op * 4) / cyclesPerMs;
+                ok = check("device (measured)", op, ms, bounds) && ok;
+            }
+            printf("device-side overruns: %u\n", eep_get_u16(p));
+            close(fd);
+            return ok ? 0 : 1;
+        }
+        fprintf(stderr, "no WCET reply from device\n");
+        close(fd);
+        return 1;
+    }
+
+    // ============ 代价模型 ============
+    if (sizes.empty()) {
+        uint16_t def[] = { 1, 16, 64, 256 };
+        sizes.assign(def, def + 4);
+    }
+    for (size_t d = 0; d < sizeof(SIM_DEVICES) / sizeof(SIM_DEVICES[0]); d++) {
+        const SimDevice& dev = SIM_DEVICES[d];
+        if (strcmp(deviceName, "all") != 0 && strcmp(deviceName, dev.name) != 0) continue;
+        for (size_t s = 0; s < sizes.size(); s++) {
+            char config[64];
+            snprintf(config, sizeof(config), "%s size=%u files=%u", dev.name, sizes[s], maxFiles);
+            for (int op = 1; op < EEP_OP_COUNT; op++) {
+                ok = check(config, op, simWorstCaseUs(dev, (uint8_t)op, sizes[s], maxFiles, opt) / 1000.0, bounds) && ok;
+            }
+        }
+    }
+    return ok ? 0 : 1;
+}
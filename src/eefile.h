@@ -2,66 +2,481 @@
 #define __EEFILE__
 #include "Arduino.h"
 #include "EEPROM.h"
+#include "eefile_backend.h"
+#include "eefile_proto.h"
+#include "eefile_wom.h"
 
 // ============ 用户定义：文件类型枚举 ============
-// 用户只需定义要保存的数据类型，地址由系统自动管理
+// 用户只需定义要保存的数据类型，地址由系统自动管理。
+// 不修改本文件：把自己的 EEFileType 放进一个头文件，编译选项中定义
+// EEFILE_TYPES_HEADER="eefile_types.h"（PlatformIO 放在 include/ 下）。
+// 枚举从 0 开始连续编号、以 END 结尾，END 即文件元数据表的大小
+#ifdef EEFILE_TYPES_HEADER
+#include EEFILE_TYPES_HEADER
+#define EEFILE_MAX_FILES ((uint8_t)EEFileType::END)   // 文件数由枚举决定
+#else
 typedef enum{
     IIC_START = 0,   // I2C地址
     KAL_MAN,         // Kalman参数
+    USER_SETTINGS,   // 用户设置（examples/BasicUsage 使用）
     // 添加新类型时直接加在这里，无需关心地址
     END              // 必须以 END 结尾
 } EEFileType;
+// 内置枚举保留原来的 10 个文件容量：位图槽大小和地址与旧版本一致，
+// 直接在上面添加类型也不必改这里
+#define EEFILE_MAX_FILES 10
+#endif
+
+// ============ EEPROM 扇区配置 ============
+// 支持使用最后 N 个扇区；可在编译选项中覆盖，以便为 CRC 表等留出空间
+#ifndef EEFILE_SECTOR_SIZE
+#define EEFILE_SECTOR_SIZE 256                     // 每个扇区 256 字节
+#endif
+#ifndef EEFILE_NUM_SECTORS
+#define EEFILE_NUM_SECTORS 2                       // 使用最后 2 个扇区
+#endif
+#define EEFILE_TOTAL_SIZE (EEFILE_SECTOR_SIZE * EEFILE_NUM_SECTORS)  // 总共 512 字节
+
+// 注意：实际地址由系统自动计算，用户无需关心
+// 地址从 0x00 开始（扇区 0），顺序分配
+
+// 默认布局（EEFILE 使用）。自定义布局提供同名的两个常量，作为 EEFileT 的模板参数
+struct EEDefaultLayout
+{
+    static const uint16_t SECTOR_SIZE = EEFILE_SECTOR_SIZE;
+    static const uint8_t NUM_SECTORS = EEFILE_NUM_SECTORS;
+};
+
+// ============ 可选功能 ============
+// 增量同步（见 eefile_sync.h）：每个文件额外占用 8 字节 RAM 记录脏区间
+#ifndef EEFILE_SYNC
+#define EEFILE_SYNC 0
+#endif
+
+// 操作轨迹记录：环形缓冲，每条 6 字节，主机用 ee_replay 回放
+#ifndef EEFILE_TRACE
+#define EEFILE_TRACE 0
+#endif
+#ifndef EEFILE_TRACE_DEPTH
+#define EEFILE_TRACE_DEPTH 32                      // 环形缓冲条数
+#endif
+
+// 最坏执行时间统计：记录每个公共接口的最大周期数，超出设定上限时报警
+#ifndef EEFILE_WCET
+#define EEFILE_WCET 0
+#endif
+#ifndef EEFILE_CYCLES
+#define EEFILE_CYCLES() ((uint32_t)micros())       // 可替换为 DWT->CYCCNT 等周期计数器
+#endif
+#ifndef EEFILE_WCET_OVERRUN
+#define EEFILE_WCET_OVERRUN(op, cycles) \
+    FILE_DEBUG("[EE] WCET: op %d took %lu > bound", op, (unsigned long)(cycles))
+#endif
+
+// 共享有效位图：所有文件的有效位集中放在区域末尾，代替每个文件 1 字节的标记。
+// 位图按槽轮转写入（每槽 [序号][位图][校验]），多个文件的有效性可一次提交
+#ifndef EEFILE_VALID_BITMAP
+#define EEFILE_VALID_BITMAP 0
+#endif
+#ifndef EEFILE_VBM_SLOTS
+#define EEFILE_VBM_SLOTS 8                         // 轮转槽数，每槽磨损降为 1/N
+#endif
+
+// 单调标记：标记字节从低位起逐位清零，第 g 代“写入中”清到第 2g-1 位，“有效”清到第 2g 位。
+// 每次改写内容进入下一代，只清零位；EEFILE_MARK_GENS 代用完后才回到擦除态（Flash 上一次擦除）。
+// 上电注册时可识别掉电时写了一半的文件（撕裂）。与旧格式（0x01/0x00）不兼容，只作用于逐文件标记字节
+#ifndef EEFILE_MONOTONIC_MARKER
+#define EEFILE_MONOTONIC_MARKER 0
+#endif
+#define EEFILE_MARK_GENS    3                      // 一个字节可容纳的代数
+#define EEFILE_MARK_ERASED  0xFF
+#define EEFILE_MARK_WRITING(g) ((uint8_t)(0xFF << (2 * (g) - 1)))  // 0xFE / 0xF8 / 0xE0
+#define EEFILE_MARK_VALID(g)   ((uint8_t)(0xFF << (2 * (g))))      // 0xFC / 0xF0 / 0xC0
+#define EEFILE_MARK_INVALID 0x00
+
+// 文件对齐：按 Flash 编程单位（2/4/8）对齐文件起点与数据区，
+// 标记独占一个单位，数据按原生宽度整块编程（见 eefile_flash.h）
+#ifndef EEFILE_ALIGN
+#define EEFILE_ALIGN 1
+#endif
+#define EEFILE_ALIGN_UP(n) ((((n) + EEFILE_ALIGN - 1) / EEFILE_ALIGN) * EEFILE_ALIGN)
+
+// 写入内容哈希：每个文件在 RAM 中保存上次写入内容的 32 位哈希（每文件 6 字节），
+// 内容不变的写入不编程、不改标记。哈希在写入或完整读出文件后建立，上电后惰性重建。
+// 哈希相同时默认读回器件逐字节确认，哈希碰撞不会让新内容被丢弃；
+// EEFILE_HASH_CONFIRM=0 省掉这次读取，只适用于明确接受“碰撞时写入被静默丢弃”的场合
+#ifndef EEFILE_WRITE_HASH
+#define EEFILE_WRITE_HASH 0
+#endif
+#ifndef EEFILE_HASH_CONFIRM
+#define EEFILE_HASH_CONFIRM 1
+#endif
+
+// 延迟挂载：begin() 只读取固定大小的区域（有效位图槽、重映射表），注册文件时不访问器件，
+// 各文件的标记校验（单调标记的撕裂检查）推迟到首次访问或 service() 中完成；
+// 环形日志 / 队列的写入位置查找同样推迟到首次访问（见 eefile_log.h）
+#ifndef EEFILE_LAZY_MOUNT
+#define EEFILE_LAZY_MOUNT 0
+#endif
+
+// 按文件选择存储策略（见 eefile_policy.h）：每个文件额外占用 2 字节 RAM 存放策略指针
+#ifndef EEFILE_POLICY
+#define EEFILE_POLICY 0
+#endif
+
+// 写入校验与坏区重映射：写入的字节立即读回比较，发现损坏的单元时把整个文件
+// 搬到备用区，并在持久化的重映射表中记录。注册时查表得到文件的实际地址，
+// 健康文件的读写没有额外开销。备用区和重映射表从 EEFILE_TOTAL_SIZE 中预留，
+// 适用于直接寻址的后端（EEPROM、I2C EEPROM）
+#ifndef EEFILE_VERIFY
+#define EEFILE_VERIFY 0
+#endif
+#ifndef EEFILE_SPARE_SIZE
+#define EEFILE_SPARE_SIZE 64                       // 备用区字节数
+#endif
+#ifndef EEFILE_REMAP_SLOTS
+#define EEFILE_REMAP_SLOTS 4                       // 重映射表条目数（每条 7 字节）
+#endif
+
+#if EEFILE_VALID_BITMAP && EEFILE_MONOTONIC_MARKER
+#error "EEFILE_MONOTONIC_MARKER applies to per-file marker bytes, not EEFILE_VALID_BITMAP"
+#endif
+
+#if EEFILE_VALID_BITMAP
+#define EEFILE_MARKER_SIZE 0                       // 文件内不再有标记字节
+#else
+#define EEFILE_MARKER_SIZE EEFILE_ALIGN            // 标记字节 + 对齐填充
+#endif
+
+// 区域末尾依次为：[备用区][重映射表][有效位图槽]，各区地址见 EEFileT 的布局常量
+#define EEFILE_REMAP_ENTRY_SIZE 7                  // [原地址 u16][新地址 u16][长度 u16][校验]
+
+// ============ 外部分析钩子（编译期可选）============
+// 在编译选项中定义 EEFILE_HOOKS_HEADER="my_hooks.h"（或直接用 -D 定义下列宏），
+// 即可在不修改 eefile.cpp 的情况下接入周期计数器、GPIO 翻转等分析手段。
+// 未定义的钩子展开为空语句，不产生任何代码。
+//   公共接口：op 为 EEP_OP_*，type 为文件类型，len 为数据长度，ok 为结果
+//   存储事务：rw 为 EEFILE_IO_READ / EEFILE_IO_WRITE，addr 为 EEPROM 地址
+#define EEFILE_IO_READ  0
+#define EEFILE_IO_WRITE 1
+
+#ifdef EEFILE_HOOKS_HEADER
+#include EEFILE_HOOKS_HEADER
+#endif
+#ifndef EEFILE_HOOK_OP_PRE
+#define EEFILE_HOOK_OP_PRE(op, type, len)        ((void)0)
+#endif
+#ifndef EEFILE_HOOK_OP_POST
+#define EEFILE_HOOK_OP_POST(op, type, len, ok)   ((void)0)
+#endif
+#ifndef EEFILE_HOOK_IO_PRE
+#define EEFILE_HOOK_IO_PRE(rw, addr, len)        ((void)0)
+#endif
+#ifndef EEFILE_HOOK_IO_POST
+#define EEFILE_HOOK_IO_POST(rw, addr, len)       ((void)0)
+#endif
 
 // ============ 最小化文件元数据结构 ============
 // 只保留必要信息，节省内存
 // 注意：Flash 中实际存储格式为：[有效性标记(1字节)] + [用户数据]
+//       （EEFILE_VALID_BITMAP=1 时没有标记字节，有效位在位图槽中）
+#if EEFILE_SYNC
+typedef struct {
+    uint16_t lo;           // 待同步脏区间起点（绝对地址），lo > hi 表示无
+    uint16_t hi;           // 待同步脏区间终点（含）
+    uint16_t sentLo;       // 已发送、等待主机确认的区间
+    uint16_t sentHi;
+} EESyncRange;
+#endif
+
+// 标记状态（标记缓存与 getMarkerState() 的返回值）
+#define EE_MARKER_INVALID   0     // 无效
+#define EE_MARKER_VALID     1     // 有效
+#define EE_MARKER_WRITING   2     // 单调标记：写入中（上电时看到即为撕裂写）
+#define EE_MARKER_ERASED    3     // 单调标记：擦除态，从未写过
+#define EE_MARKER_TORN      4     // 单调标记：不是任何合法编码（标记本身写了一半）
+#define EE_MARKER_UNKNOWN   0xFF  // 标记缓存：尚未从 EEPROM 读取
+
+#if EEFILE_POLICY
+struct EEPolicy;
+
+// ============ 策略访问文件区的原始接口 ============
+// 偏移相对于文件数据区，不检查范围、不计入读写统计和轨迹。
+// 策略的操作表不是模板，通过它访问任何实例的文件（实现见 eefile_policy.h 的 EEPolicyPort）
+class EEPolicyIO
+{
+  public:
+    virtual void read(uint16_t off, uint8_t* buf, uint16_t len) = 0;
+    // 写入 data 的 len 字节，之后到 total 字节填充 0xFF，内容未变的字节不重复编程
+    virtual void write(uint16_t off, const uint8_t* data, uint16_t len, uint16_t total) = 0;
+    virtual bool valid(void) = 0;
+    virtual void setValid(bool valid) = 0;
+};
+#endif
+
 typedef struct {
-    EEFileType type;          // 文件类型
+    uint8_t type;             // 文件类型（枚举值）
     uint16_t maxSize;         // 最大数据大小（字节，不包括有效性标记）
-    uint16_t startAddr;       // 自动分配的起始地址（有效性标记的地址）
-    uint16_t endAddr;         // 自动分配的结束地址
+    uint16_t startAddr;       // 起始地址（有效性标记的地址），重映射后位于备用区
+    uint16_t endAddr;         // 自动分配的结束地址（不随重映射改变）
     uint16_t dataLen;         // 实际数据长度（不包括有效性标记）
     bool enabled;          // 是否启用
     bool modified;         // 是否内容改变
     // 注意：valid 标志现在存储在 Flash 的第一个字节，不再用内存中的字段
+    uint8_t marker;        // 标记缓存：EE_MARKER_*，EE_MARKER_UNKNOWN=未读取
+#if EEFILE_MONOTONIC_MARKER
+    uint8_t markerGen;     // 单调标记当前代（1..EEFILE_MARK_GENS），擦除态/失效为 0
+#endif
+#if EEFILE_SYNC
+    EESyncRange sync;      // 增量同步区间
+#endif
+#if EEFILE_POLICY
+    EEPolicy* policy;      // 存储策略，NULL 为默认的写直通
+#endif
+#if EEFILE_WRITE_HASH
+    uint32_t hash;         // 上次写入（或完整读出）内容的哈希，含填充
+    bool hashKnown;        // hash 是否与器件内容一致
+#endif
 } FileMetadata;
 
-// ============ EEPROM 扇区配置 ============
-// 支持使用最后 N 个扇区
-#define EEFILE_MAX_FILES 10                        // 最多支持 10 个文件
-#define EEFILE_SECTOR_SIZE 256                     // 每个扇区 256 字节
-#define EEFILE_NUM_SECTORS 2                       // 使用最后 2 个扇区
-#define EEFILE_TOTAL_SIZE (EEFILE_SECTOR_SIZE * EEFILE_NUM_SECTORS)  // 总共 512 字节
-
-// 注意：实际地址由系统自动计算，用户无需关心
-// 地址从 0x00 开始（扇区 0），顺序分配
+// ============ 运行计数（用于监控与二进制状态导出）============
+typedef struct {
+    uint32_t reads;            // 成功读取次数
+    uint32_t writes;           // 成功写入次数
+    uint32_t erases;           // 擦除次数
+    uint32_t bytesProgrammed;  // 实际编程的字节数（差分写跳过的不计）
+    uint16_t errors;           // 失败的操作次数
+    uint32_t markerWrites;     // 有效性标记实际编程的字节数
+    uint32_t markerSkips;      // 因状态未变而省去的标记写入次数
+    uint32_t hashSkips;        // 因内容哈希相同而跳过的写入次数（EEFILE_WRITE_HASH）
+    uint16_t verifyFailures;   // 写后读回不一致的次数（EEFILE_VERIFY）
+    uint16_t remaps;           // 文件被搬到备用区的次数（EEFILE_VERIFY）
+} EEStats;
+
+#if EEFILE_TRACE
+// ============ 操作轨迹记录（格式见 eefile_proto.h）============
+typedef struct {
+    uint16_t dt;               // 距上一条的毫秒数
+    uint8_t op;                // EEP_OP_*，bit7 表示失败
+    uint8_t type;              // 文件类型
+    uint16_t len;              // 数据长度
+} EETraceRecord;
+#endif
+
+// ============ 元数据表容量 ============
+// 按 END 精确分配；内置枚举使用 EEFILE_MAX_FILES
+template <class FileType>
+struct EEFileCapacity
+{
+    static const uint8_t value = (uint8_t)FileType::END;
+};
 
-class EEFILE
+#ifndef EEFILE_TYPES_HEADER
+template <>
+struct EEFileCapacity<EEFileType>
 {
+    static const uint8_t value = EEFILE_MAX_FILES;
+};
+#endif
+
+// ============ 文件系统核心 ============
+// Backend：存储后端类型。EEBackend 经虚函数调用，可在运行时 setBackend() 更换；
+//          具体的 final 后端（如 EEPROMBackend）调用被内联
+// Layout： 布局常量（SECTOR_SIZE / NUM_SECTORS），地址计算和越界检查在编译期折叠
+// FileType：文件类型枚举，从 0 连续编号、以 END 结尾（可以是 enum class），END 不超过 254；
+//           元数据表按 END 分配（见 EEFileCapacity），按类型查找直接下标访问
+// 默认实例 EEFILE = EEFileT<EEBackend, EEDefaultLayout, EEFileType>，EE_* 宏和所有扩展模块
+// 都使用它；其它实例化见 eefile_impl.h
+template <class Backend, class Layout, class FileType = EEFileType>
+class EEFileT
+{
+  public:
+    // 0xFF 是 fileIndex 中“未注册”的标记
+    static_assert((unsigned)FileType::END < 0xFF, "FileType::END must be at most 254");
+    static_assert(EEFileCapacity<FileType>::value >= (unsigned)FileType::END &&
+                  EEFileCapacity<FileType>::value < 0xFF, "file table must hold every FileType");
+
+    // ============ 布局常量 ============
+    static const uint8_t MAX_FILES = EEFileCapacity<FileType>::value;
+    static const uint16_t TOTAL_SIZE = Layout::SECTOR_SIZE * Layout::NUM_SECTORS;
+#if EEFILE_VALID_BITMAP
+    static const uint8_t VBM_BYTES = (MAX_FILES + 7) / 8;
+    static const uint8_t VBM_SLOT_SIZE = VBM_BYTES + 2;
+    static const uint16_t VBM_ADDR = TOTAL_SIZE - EEFILE_VBM_SLOTS * VBM_SLOT_SIZE;
+    static const uint16_t AREA_END = VBM_ADDR;
+#else
+    static const uint16_t AREA_END = TOTAL_SIZE;
+#endif
+#if EEFILE_VERIFY
+    static const uint16_t REMAP_ADDR = AREA_END - EEFILE_REMAP_SLOTS * EEFILE_REMAP_ENTRY_SIZE;
+    static const uint16_t SPARE_ADDR = REMAP_ADDR - EEFILE_SPARE_SIZE;
+    static const uint16_t DATA_SIZE = SPARE_ADDR;      // 文件可用空间
+#else
+    static const uint16_t DATA_SIZE = AREA_END;
+#endif
+
   private:
+    static const uint8_t NO_FILE = 0xFF;   // fileIndex / findFileIndex：类型未注册
+
     // 内部状态
-    FileMetadata files[EEFILE_MAX_FILES];  // 文件元数据表
+    FileMetadata files[MAX_FILES];         // 文件元数据表（按注册顺序）
+    uint8_t fileIndex[MAX_FILES];          // 文件类型 -> files 下标，0xFF 表示未注册
     uint8_t fileCount;                     // 已注册的文件数量
     bool is_enabled;                    // EEPROM 功能是否启用
+    Backend* backend;                      // 存储后端
+    EEStats stats;                         // 运行计数
+
+#if EEFILE_TRACE
+    EETraceRecord trace[EEFILE_TRACE_DEPTH];  // 轨迹环形缓冲
+    uint8_t traceHead;                     // 最旧一条的下标
+    uint8_t traceCount;
+    uint16_t traceDropped;                 // 缓冲满后被覆盖的条数
+    uint32_t traceLastMs;
+    void traceOp(uint8_t op, FileType type, uint16_t length, bool ok);
+#endif
+
+#if EEFILE_WCET
+    uint32_t wcetMax[EEP_OP_COUNT];        // 以 EEP_OP_* 为下标的最大周期数
+    uint32_t wcetBound[EEP_OP_COUNT];      // 上限，0 表示不检查
+    uint16_t wcetOverruns;                 // 超出上限的次数
+#endif
+
+#if EEFILE_TRACE || EEFILE_WCET
+    void opDone(uint8_t op, FileType type, uint16_t length, bool ok, uint32_t cycles);
+#endif
 
     // 内部方法
     uint16_t calculateCRC(const uint8_t* data, uint16_t length);
     bool verifyCRC(const uint8_t* data, uint16_t length, uint16_t crc);
-    int8_t findFileIndex(EEFileType type);
+    uint8_t findFileIndex(FileType type);
     uint16_t calculateNextAddr(void);
+    bool updateByte(uint8_t idx, uint16_t addr, uint8_t value);
+    uint16_t updateBlock(uint8_t idx, uint16_t addr, const uint8_t* data, uint16_t len, uint16_t total);
+
+    // 有效性标记：逐文件标记字节，或共享位图中的一位
+    bool markerValid(uint8_t idx);
+    void setMarker(uint8_t idx, bool valid);
+#if !EEFILE_VALID_BITMAP
+    uint8_t markerState(uint8_t idx);
+    void markerProgram(uint8_t idx, uint8_t state);
+#endif
+#if EEFILE_MONOTONIC_MARKER
+    uint8_t markerArm;                     // 首次真正编程前要进入“写入中”的文件，NO_FILE 表示无
+    void markerBeginWrite(uint8_t idx);
+#endif
+
+#if EEFILE_VALID_BITMAP
+    uint8_t vbm[VBM_BYTES];                // 当前位图，bit i 对应第 i 个注册的文件
+    uint8_t vbmSlot;                       // 最新有效槽
+    uint8_t vbmSeq;                        // 最新有效槽的序号
+    bool vbmSetBit(uint8_t idx, bool valid);
+    bool vbmReadSlot(uint8_t slot, uint8_t* seq, uint8_t* bits);
+    void vbmLoad(void);
+    void vbmCommit(void);
+#endif
+
+    // 所有存储访问都经过这里，便于挂接分析钩子
+    uint8_t ioRead(uint16_t addr)
+    {
+        EEFILE_HOOK_IO_PRE(EEFILE_IO_READ, addr, 1);
+        uint8_t v = backend->read(addr);
+        EEFILE_HOOK_IO_POST(EEFILE_IO_READ, addr, 1);
+        return v;
+    }
+
+    void ioReadBlock(uint16_t addr, uint8_t* buf, uint16_t len)
+    {
+        EEFILE_HOOK_IO_PRE(EEFILE_IO_READ, addr, len);
+        backend->readBlock(addr, buf, len);
+        EEFILE_HOOK_IO_POST(EEFILE_IO_READ, addr, len);
+    }
+
+    void ioWrite(uint16_t addr, uint8_t value)
+    {
+        EEFILE_HOOK_IO_PRE(EEFILE_IO_WRITE, addr, 1);
+        backend->write(addr, value);
+        EEFILE_HOOK_IO_POST(EEFILE_IO_WRITE, addr, 1);
+    }
+
+    void ioWriteBlock(uint16_t addr, const uint8_t* buf, uint16_t len)
+    {
+        EEFILE_HOOK_IO_PRE(EEFILE_IO_WRITE, addr, len);
+        backend->writeBlock(addr, buf, len);
+        EEFILE_HOOK_IO_POST(EEFILE_IO_WRITE, addr, len);
+    }
+
+    // 结束一次写操作：记录式后端在 flush 时才真正编程，flush 中后端报错则写入失败
+    bool flushBackend(void)
+    {
+        uint16_t backendErrors = backend->getErrorCount();
+        backend->flush();
+        if (backend->getErrorCount() != backendErrors) {
+            FILE_DEBUG("[EE] ERROR: backend write error");
+            stats.errors++;
+            return false;
+        }
+        return true;
+    }
+    bool doWrite(FileType type, const uint8_t* data, uint16_t length, bool commit);
+    bool doRead(FileType type, uint8_t* data, uint16_t length);
+    bool doErase(FileType type);
+    int8_t womCurrentSlot(uint8_t idx, uint8_t bits, uint8_t* slot);
+    bool doWriteWom(FileType type, uint16_t value, uint8_t bits);
+    uint8_t rangeIndex(FileType type, uint16_t offset, uint16_t length);
+    uint16_t statusHead(uint8_t* buf);
+    void statusRecord(uint8_t i, const uint8_t* bitmap, uint8_t* rec);
+#if EEFILE_VERIFY
+    bool verifyFailed;                     // 上次检查以来有写入读回不一致
+    uint8_t remapUsed;                     // 重映射表已用条目数
+    uint16_t spareNext;                    // 备用区下一个空闲地址
+    uint16_t remapFrom[EEFILE_REMAP_SLOTS];  // 表项缓存：原地址，0xFFFF 为空或损坏
+    uint16_t remapTo[EEFILE_REMAP_SLOTS];    // 表项缓存：备用区地址
+    bool remapEntry(uint8_t slot, uint16_t* from, uint16_t* to, uint16_t* len);
+    void remapLoad(void);
+    uint16_t remapLookup(uint16_t from);
+    bool remapFile(uint8_t idx);
+#endif
+#if EEFILE_WRITE_HASH
+    uint32_t contentHash(const uint8_t* data, uint16_t len, uint16_t total);
+    bool sameContent(uint8_t idx, const uint8_t* data, uint16_t len, uint32_t hash);
+    void forgetHashes(void);
+#endif
+
+#if EEFILE_SYNC
+#if EEFILE_VALID_BITMAP
+    EESyncRange vbmSync;                   // 位图槽区域的同步区间（下标 fileCount）
+#endif
+#if EEFILE_VERIFY
+    EESyncRange remapSync;                 // 备用区和重映射表的同步区间（位图之后）
+#endif
+    EESyncRange* syncRange(uint8_t idx);
+    uint8_t syncRangeCount(void) const;
+    void markDirty(uint8_t idx, uint16_t addr);
+    friend class EESync;
+#endif
+
+#if EEFILE_POLICY
+    EEPolicy* policyOf(uint8_t idx);
+    template <class Fs> friend class EEPolicyPort;
+#endif
 
   public:
     // Constructor
-    EEFILE();
+    EEFileT();
 
-    // 单例模式
-    static EEFILE &getInstance(void)
+    // 单例模式（每个实例化各有一个）
+    static EEFileT &getInstance(void)
     {
-        static EEFILE eefile;
+        static EEFileT eefile;
         return eefile;
     }
 
     // ========== 初始化 ==========
+    /**
+     * @brief 更换存储后端（默认 EEPROMBackend），须在 begin() 之前调用
+     * @note Backend 不是 EEBackend / EEPROMBackend 时没有默认后端，必须调用
+     */
+    void setBackend(Backend &b);
     void begin();
 
     // ========== 启用/禁用 ==========
@@ -69,11 +484,25 @@ class EEFILE
     void disable();
     bool isEnabled() const;
 
+    // ========== 延迟挂载 ==========
+    /**
+     * @brief 完成一项推迟的工作（校验一个文件的标记），可在主循环空闲时反复调用；
+     *        同时执行后端的周期性工作（EEBackend::service()）
+     * @return 是否仍有推迟的工作
+     */
+    bool service(void);
+
+    /**
+     * @brief 尚未校验的文件，bit i 对应第 i 个注册的文件（前 32 个）
+     */
+    uint32_t getDeferredMask(void) const;
+
     // ========== 自动地址注册（核心接口）==========
     /**
      * @brief 自动注册文件，系统自动分配地址
-     * @param type 文件类型（EEFileType 枚举）
+     * @param type 文件类型（FileType 枚举，默认实例为 FileType）
      * @param maxSize 该文件的最大数据大小（字节）
+     * @param tier 存放层级：EEFILE_TIER_SLOW（默认）或 EEFILE_TIER_FAST（需要 EETierBackend）
      * @return 注册是否成功
      *
      * 使用示例：
@@ -81,7 +510,21 @@ class EEFILE
      *   EE.registerAuto(KAL_MAN, 4);        // Kalman参数，4字节
      *   地址会自动分配：0x0A, 0x13, 0x1C 等
      */
-    bool registerAuto(EEFileType type, uint16_t maxSize);
+    bool registerAuto(FileType type, uint16_t maxSize, uint8_t tier = EEFILE_TIER_SLOW);
+
+#if EEFILE_POLICY
+    /**
+     * @brief 按策略注册文件（EEFILE_POLICY=1，策略定义见 eefile_policy.h）
+     * @param policy 策略描述，须在文件的整个生命周期内有效（通常为全局变量）
+     * @note 文件区按策略展开后的大小分配，getFileMaxSize() 返回展开后的大小
+     */
+    bool registerPolicy(FileType type, EEPolicy& policy);
+
+    /**
+     * @brief 立即写回所有回写缓存（掉电或休眠前调用）
+     */
+    void flush(void);
+#endif
 
     // ========== 读写接口（使用枚举而非地址）==========
     /**
@@ -91,7 +534,14 @@ class EEFILE
      * @param length 数据长度
      * @return 写入是否成功
      */
-    bool write(EEFileType type, const uint8_t* data, uint16_t length);
+    bool write(FileType type, const uint8_t* data, uint16_t length);
+
+    /**
+     * @brief 写入数据并提交有效标记（等价于 write + setFileValid(true)）
+     * @note 先写数据再写标记，标记已有效时不再编程
+     * @return 写入是否成功
+     */
+    bool writeCommit(FileType type, const uint8_t* data, uint16_t length);
 
     /**
      * @brief 从 EEPROM 读取数据
@@ -100,61 +550,164 @@ class EEFILE
      * @param length 期望读取长度
      * @return 读取是否成功
      */
-    bool read(EEFileType type, uint8_t* data, uint16_t length);
+    bool read(FileType type, uint8_t* data, uint16_t length);
+
+    // ========== WOM 编码的小数值 ==========
+    /**
+     * @brief 以 WOM 编码写入小数值（模式、标志、小计数器），只清零位，
+     *        同一槽可改写两代，所有槽写满才整体擦除一次
+     * @param type 文件类型，注册大小用 EEFILE_WOM_SIZE(bits, 槽数)
+     * @param value 待写入的值（低 bits 位有效）
+     * @param bits 值的位数（1..16），读写时必须一致
+     * @return 写入是否成功
+     */
+    bool writeWom(FileType type, uint16_t value, uint8_t bits);
+
+    /**
+     * @brief 读取 WOM 编码的值
+     * @return 读取是否成功（文件无效时返回 false）
+     */
+    bool readWom(FileType type, uint16_t* value, uint8_t bits);
+
+    // ========== 部分读写（日志、队列等记录式文件类型使用）==========
+    /**
+     * @brief 读取文件数据区中 [offset, offset+length) 的内容，不检查有效性标记
+     * @return 文件存在且范围未越界时返回 true
+     */
+    bool readAt(FileType type, uint16_t offset, uint8_t* data, uint16_t length);
+
+    /**
+     * @brief 差分写入文件数据区的一部分，不改变有效性标记，其余字节保持不变
+     * @param commit false 时暂不提交后端缓冲（同一条记录分几段写入时，除最后一段外传 false）
+     * @note 记录式文件类型自己保证完整性（如每条记录带 CRC）
+     * @return 写入是否成功
+     */
+    bool writeAt(FileType type, uint16_t offset, const uint8_t* data, uint16_t length,
+        bool commit = true);
 
     // ========== 文件操作 ==========
     /**
      * @brief 清除指定文件
      */
-    bool erase(EEFileType type);
+    bool erase(FileType type);
 
     /**
      * @brief 设置文件启用/禁用状态
      */
-    void setFileEnabled(EEFileType type, bool enabled);
+    void setFileEnabled(FileType type, bool enabled);
 
     /**
      * @brief 获取文件启用状态
      */
-    bool isFileEnabled(EEFileType type);
+    bool isFileEnabled(FileType type);
 
     /**
      * @brief 获取文件实际数据长度
      */
-    uint16_t getFileDataLen(EEFileType type);
+    uint16_t getFileDataLen(FileType type);
+
+    /**
+     * @brief 获取文件注册时的最大数据大小
+     */
+    uint16_t getFileMaxSize(FileType type);
 
     /**
      * @brief 获取文件是否被修改
      */
-    bool isFileModified(EEFileType type);
+    bool isFileModified(FileType type);
 
     /**
      * @brief 清除文件修改标志
      */
-    void clearModifiedFlag(EEFileType type);
+    void clearModifiedFlag(FileType type);
 
     /**
      * @brief 获取文件在 EEPROM 中的起始地址（用于调试）
      */
-    uint16_t getFileAddr(EEFileType type);
+    uint16_t getFileAddr(FileType type);
 
     /**
      * @brief 获取文件有效标志位
      * @return true 表示数据有效，false 表示数据无效
      */
-    bool isFileValid(EEFileType type);
+    bool isFileValid(FileType type);
 
     /**
      * @brief 设置文件有效标志位
      * @param valid true=有效, false=无效
      */
-    void setFileValid(EEFileType type, bool valid);
+    void setFileValid(FileType type, bool valid);
+
+    /**
+     * @brief 一次设置多个文件的有效标志位
+     * @param types 文件类型数组
+     * @param count 数组长度
+     * @param valid true=有效, false=无效
+     * @note EEFILE_VALID_BITMAP=1 时只提交一次位图槽，多个文件同时生效
+     */
+    void setFilesValid(const FileType* types, uint8_t count, bool valid);
+
+    /**
+     * @brief 获取标记状态（EE_MARKER_*）
+     * @note EEFILE_MONOTONIC_MARKER=1 时 EE_MARKER_WRITING / EE_MARKER_TORN
+     *       表示上次写入被掉电打断
+     */
+    uint8_t getMarkerState(FileType type);
 
     // ========== 调试接口 ==========
     void printStatus();
-    void printFileInfo(EEFileType type);
+    void printFileInfo(FileType type);
+
+    // ========== 监控接口（机器可读）==========
+    const EEStats &getStats() const;
+    void resetStats();
+
+    /**
+     * @brief 导出二进制状态（文件表 + 有效位图 + 计数），格式见 eefile_proto.h
+     * @param buf 输出缓冲区，大小至少 EEP_STATUS_SIZE(文件数)
+     * @return 写入字节数，缓冲区不足返回 0
+     */
+    uint16_t exportStatus(uint8_t* buf, uint16_t size);
+
+    /**
+     * @brief 以 EEP_CMD_STATUS 帧写出状态，主机用 ee_status_decode 解析
+     * @note 记录逐条写出，栈占用与文件数无关；超过 10 个文件时负载大于 EEP_MAX_PAYLOAD
+     */
+    void printStatusBinary(Print &out);
+
+#if EEFILE_TRACE
+    /**
+     * @brief 取出并清空轨迹，以 EEP_CMD_TRACE 帧输出（每帧最多 EEP_TRACE_PER_FRAME 条）
+     * @return 输出的记录条数
+     */
+    uint16_t printTraceBinary(Print &out);
+#endif
+
+#if EEFILE_WCET
+    /**
+     * @brief 最坏执行时间（单位由 EEFILE_CYCLES() 决定，默认微秒）
+     * @param op EEP_OP_*（EEP_OP_BEGIN 对应 begin()）
+     */
+    uint32_t getWorstCycles(uint8_t op) const;
+
+    /**
+     * @brief 设置某个接口的上限，超出时计数并调用 EEFILE_WCET_OVERRUN(op, cycles)
+     */
+    void setCycleBound(uint8_t op, uint32_t cycles);
+    uint16_t getWcetOverruns() const;
+    void resetWcet();
+
+    /**
+     * @brief 以 EEP_CMD_WCET 帧输出各接口最坏值，主机用 ee_wcet --tty 检查
+     */
+    void printWcetBinary(Print &out);
+#endif
 };
 
+// 默认实例：成员在 eefile.cpp 中实例化一次，包含本头文件的其它编译单元不再重复生成
+extern template class EEFileT<EEBackend, EEDefaultLayout>;
+typedef EEFileT<EEBackend, EEDefaultLayout> EEFILE;
+
 extern HardwareSerial hwSerial;
 
 // ============ 便捷接口宏（简化调用）============
@@ -166,11 +719,21 @@ extern HardwareSerial hwSerial;
 // 自动注册文件（推荐方式）
 #define EE_REG(type, size) EE.registerAuto(type, size)
 
+// 注册到指定层级（频繁改写的文件放 EEFILE_TIER_FAST）
+#define EE_REG_TIER(type, size, tier) EE.registerAuto(type, size, tier)
+
 // 写入数据（使用枚举，地址自动对应）
 #define EE_WRITE(type, data, len) EE.write(type, (uint8_t*)data, len)
 
+// 写入并标记有效（代替 EE_WRITE + EE_SET_VALID）
+#define EE_WRITE_COMMIT(type, data, len) EE.writeCommit(type, (uint8_t*)data, len)
+
 // 读取数据
-#define EE_READ(type, buffer, len) EE.read(type, buffer, len)
+#define EE_READ(type, buffer, len) EE.read(type, (uint8_t*)buffer, len)
+
+// WOM 编码的小数值（注册：EE_REG(type, EEFILE_WOM_SIZE(bits, 槽数))）
+#define EE_WOM_WRITE(type, value, bits) EE.writeWom(type, value, bits)
+#define EE_WOM_READ(type, pvalue, bits) EE.readWom(type, pvalue, bits)
 
 // 文件操作
 #define EE_ERASE(type) EE.erase(type)
@@ -186,9 +749,12 @@ extern HardwareSerial hwSerial;
 // 启动标志位（最重要的特性）
 #define EE_IS_VALID(type) EE.isFileValid(type)       // 检查数据是否有效
 #define EE_SET_VALID(type, v) EE.setFileValid(type, v)  // 设置有效标志
+#define EE_SET_VALID_MULTI(types, n, v) EE.setFilesValid(types, n, v)  // 批量设置
 
 // 调试输出
 #define EE_STATUS() EE.printStatus()
 #define EE_INFO(type) EE.printFileInfo(type)
+#define EE_STATUS_BIN(out) EE.printStatusBinary(out)
+#define EE_TRACE_DUMP(out) EE.printTraceBinary(out)
 
 #endif
\ No newline at end of file
@@ -0,0 +1,188 @@
+/**
+ * @file eefile_backend.h
+ * @brief 存储后端接口：EEFILE 的所有读写都经过 EEBackend
+ *
+ * 默认后端 EEPROMBackend 包装平台的 ::EEPROM；其它后端（原始 Flash 等）
+ * 在 begin() 之前用 EE.setBackend(backend) 接入。
+ *
+ * 以具体后端实例化 EEFileT（见 eefile.h）时，final 的后端（EEPROMBackend）
+ * 调用不经过虚函数表，可以被内联；自己的后端类同样可以声明为 final。
+ */
+
+#ifndef __EEFILE_BACKEND__
+#define __EEFILE_BACKEND__
+
+#include "Arduino.h"
+#include "EEPROM.h"
+
+// 文件所在层级（registerAuto 的 tier 参数，见 eefile_tier.h / eefile_mirror.h）
+#define EEFILE_TIER_SLOW    0       // 主存储（EEPROM / Flash）
+#define EEFILE_TIER_FAST    1       // 快速层（掉电保持 RAM / FRAM），定期检查点到主存储
+#define EEFILE_TIER_MIRROR  2       // 两个器件各存一份（见 eefile_mirror.h）
+
+class EEBackend
+{
+  public:
+    virtual ~EEBackend() {}
+
+    virtual void begin() {}
+
+    virtual uint8_t read(uint16_t addr) = 0;
+    virtual void write(uint16_t addr, uint8_t value) = 0;
+
+    virtual void readBlock(uint16_t addr, uint8_t* buf, uint16_t len)
+    {
+        for (uint16_t i = 0; i < len; i++) {
+            buf[i] = read(addr + i);
+        }
+    }
+
+    /**
+     * @brief 写入一段连续字节，后端按自己的编程单位合并
+     */
+    virtual void writeBlock(uint16_t addr, const uint8_t* buf, uint16_t len)
+    {
+        for (uint16_t i = 0; i < len; i++) {
+            write(addr + i, buf[i]);
+        }
+    }
+
+    /**
+     * @brief 最小编程单位（字节），EEFILE_ALIGN 应取它的整数倍
+     */
+    virtual uint16_t programUnit() const
+    {
+        return 1;
+    }
+
+    /**
+     * @brief 差分写时是否把一段变化合并成一次 writeBlock()
+     * @note 按单位编程的器件总是合并；可按字节写、但每次写入都有固定写周期的器件
+     *       （I2C 页写 EEPROM）也应返回 true，一段只占一个写周期
+     */
+    virtual bool coalesceWrites() const
+    {
+        return programUnit() > 1;
+    }
+
+    /**
+     * @brief 累计错误次数（无应答、两份副本都损坏等）
+     * @note 读取文件期间计数增加时，核心把这次读取判为失败；
+     *       写操作结束的 flush 中计数增加时，把这次写入判为失败
+     */
+    virtual uint16_t getErrorCount() const
+    {
+        return 0;
+    }
+
+    /**
+     * @brief 声明 [addr, addr+len) 属于同一个文件（注册文件时调用），
+     *        记录式后端据此按文件组织存储
+     * @param tier EEFILE_TIER_*，普通后端只接受 EEFILE_TIER_SLOW
+     * @return 后端能否容纳该区域
+     */
+    virtual bool mapRegion(uint8_t id, uint16_t addr, uint16_t len, uint8_t tier)
+    {
+        (void)id;
+        (void)addr;
+        (void)len;
+        return tier == EEFILE_TIER_SLOW;
+    }
+
+    /**
+     * @brief 提交缓冲中的写入，每个公共写操作结束时调用
+     */
+    virtual void flush() {}
+
+    /**
+     * @brief 空闲时的周期性工作（分层存储的定时检查点等），由 EE.service() 调用
+     */
+    virtual void service() {}
+};
+
+// ============ 默认后端：平台 EEPROM（或厂商提供的 EEPROM 模拟层）============
+class EEPROMBackend final : public EEBackend
+{
+  public:
+    static EEPROMBackend &getInstance(void)
+    {
+        static EEPROMBackend backend;
+        return backend;
+    }
+
+    void begin()
+    {
+        ::EEPROM.begin();
+    }
+
+    uint8_t read(uint16_t addr)
+    {
+        return ::EEPROM.read(addr);
+    }
+
+    void write(uint16_t addr, uint8_t value)
+    {
+        ::EEPROM.write(addr, value);
+    }
+
+    void flush()
+    {
+#if defined(ESP8266) || defined(ESP32)
+        ::EEPROM.commit();                 // ESP 的 EEPROM 是 RAM 镜像，需要显式提交
+#endif
+    }
+};
+
+// ============ 内存映射后端：备份域 RAM、RTC 保持内存、电池供电 SRAM ============
+class EERamBackend : public EEBackend
+{
+  public:
+    EERamBackend(volatile uint8_t* mem, uint16_t size) : mem(mem), size(size) {}
+
+    uint8_t read(uint16_t addr)
+    {
+        return (addr < size) ? mem[addr] : 0xFF;
+    }
+
+    void write(uint16_t addr, uint8_t value)
+    {
+        if (addr < size) {
+            mem[addr] = value;
+        }
+    }
+
+  private:
+    volatile uint8_t* mem;
+    uint16_t size;
+};
+
+// ============ EEFileT 构造时的默认后端 ============
+// 平台 EEPROM 可以直接使用；其它后端没有全局实例，须在 begin() 之前 setBackend()
+template <class Backend>
+struct EEBackendDefault
+{
+    static Backend* get(void)
+    {
+        return NULL;
+    }
+};
+
+template <>
+struct EEBackendDefault<EEBackend>
+{
+    static EEBackend* get(void)
+    {
+        return &EEPROMBackend::getInstance();
+    }
+};
+
+template <>
+struct EEBackendDefault<EEPROMBackend>
+{
+    static EEPROMBackend* get(void)
+    {
+        return &EEPROMBackend::getInstance();
+    }
+};
+
+#endif
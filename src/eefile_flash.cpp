@@ -0,0 +1,297 @@
+/**
+ * @file eefile_flash.cpp
+ * @brief 原始片上 Flash 后端实现：按原生宽度编程，必要时整页擦除重写
+ */
+
+#include "eefile_flash.h"
+
+#if EEFILE_FLASH
+
+EEFlashBackend::EEFlashBackend(uintptr_t base, uint16_t size, uint32_t pageSize,
+    uint16_t unit, uint8_t* pageBuf, bool clearOverwrite)
+    : base(base), size(size), pageSize(pageSize), unit(unit),
+      pageBuf(pageBuf), clearOverwrite(clearOverwrite),
+      programs(0), erases(0), errors(0)
+{
+}
+
+// ============ 读：内存映射 ============
+uint8_t EEFlashBackend::read(uint16_t addr)
+{
+    return *(const volatile uint8_t*)(base + addr);
+}
+
+void EEFlashBackend::readBlock(uint16_t addr, uint8_t* buf, uint16_t len)
+{
+    const volatile uint8_t* p = (const volatile uint8_t*)(base + addr);
+    for (uint16_t i = 0; i < len; i++) {
+        buf[i] = p[i];
+    }
+}
+
+void EEFlashBackend::write(uint16_t addr, uint8_t value)
+{
+    writeBlock(addr, &value, 1);
+}
+
+uint16_t EEFlashBackend::programUnit() const
+{
+    return unit;
+}
+
+// ============ 写：按编程单位合并 ============
+// 每个涉及的单位：内容不变则跳过；原为擦除态（或器件允许只清零位的覆盖编程）
+// 则直接编程；否则整页读入页缓冲、擦除、写回
+void EEFlashBackend::writeBlock(uint16_t addr, const uint8_t* buf, uint16_t len)
+{
+    if (addr >= size || len > size - addr) {
+        FILE_DEBUG("[EEFLASH] ERROR: 0x%04X+%d out of range", addr, len);
+        errors++;
+        return;
+    }
+
+    uint16_t end = addr + len;
+    uint16_t u = addr - addr % unit;
+    while (u < end) {
+        const volatile uint8_t* cur = (const volatile uint8_t*)(base + u);
+        bool changed = false;
+        bool erased = true;
+        bool clearOnly = true;
+        for (uint16_t i = 0; i < unit; i++) {
+            uint16_t a = u + i;
+            uint8_t old = cur[i];
+            uint8_t v = (a >= addr && a < end) ? buf[a - addr] : old;
+            pageBuf[i] = v;
+            changed = changed || (v != old);
+            erased = erased && (old == 0xFF);
+            clearOnly = clearOnly && ((old & v) == v);
+        }
+
+        if (!changed) {
+            u += unit;
+        } else if (erased || (clearOverwrite && clearOnly)) {
+            program(u, pageBuf);
+            u += unit;
+        } else {
+            uint16_t page = u - u % pageSize;
+            rewritePage(page, addr, buf, len);
+            u = page + pageSpan(page);
+        }
+    }
+}
+
+bool EEFlashBackend::program(uint16_t addr, const uint8_t* data)
+{
+    if (!eefile_flash_program(base + addr, data, unit)) {
+        FILE_DEBUG("[EEFLASH] ERROR: program 0x%04X failed", addr);
+        errors++;
+        return false;
+    }
+    programs++;
+    return true;
+}
+
+// 页内属于本区域的字节数（区域小于一页时只到区域末尾）
+uint16_t EEFlashBackend::pageSpan(uint16_t page) const
+{
+    uint16_t rest = size - page;
+    return (pageSize < rest) ? (uint16_t)pageSize : rest;
+}
+
+// ============ 整页擦除重写（合并本次写入中落在该页的全部字节）============
+// 擦除与写回之间掉电会丢失整页内容，见 eefile_flash.h
+void EEFlashBackend::rewritePage(uint16_t page, uint16_t addr, const uint8_t* buf, uint16_t len)
+{
+    uint16_t span = pageSpan(page);
+    readBlock(page, pageBuf, span);
+
+    uint16_t lo = (addr > page) ? addr : page;
+    uint16_t hi = (addr + len < page + span) ? addr + len : page + span;
+    for (uint16_t a = lo; a < hi; a++) {
+        pageBuf[a - page] = buf[a - addr];
+    }
+
+    if (!eefile_flash_erase(base + page, pageSize)) {
+        FILE_DEBUG("[EEFLASH] ERROR: erase 0x%04X failed", page);
+        errors++;
+        return;
+    }
+    erases++;
+
+    // 擦除后全 0xFF 的单位不必编程
+    for (uint16_t u = 0; u < span; u += unit) {
+        bool blank = true;
+        for (uint16_t i = 0; i < unit && blank; i++) {
+            blank = (pageBuf[u + i] == 0xFF);
+        }
+        if (!blank) {
+            program(page + u, pageBuf + u);
+        }
+    }
+}
+
+uint32_t EEFlashBackend::getProgramCount() const
+{
+    return programs;
+}
+
+uint32_t EEFlashBackend::getEraseCount() const
+{
+    return erases;
+}
+
+uint16_t EEFlashBackend::getErrorCount() const
+{
+    return errors;
+}
+
+// ============ 默认编程/擦除实现（STM32 HAL），其它器件在应用中重新定义 ============
+extern "C" __attribute__((weak))
+bool eefile_flash_program(uintptr_t addr, const uint8_t* data, uint16_t unit)
+{
+#if defined(HAL_FLASH_MODULE_ENABLED) && defined(FLASH_TYPEPROGRAM_FLASHWORD)
+    // H7：一次编程一个 Flash 字，HAL 传入的是数据地址而不是数据本身
+    uint32_t w[FLASH_NB_32BITWORD_IN_FLASHWORD];
+    if (unit != sizeof(w)) {
+        return false;
+    }
+    memcpy(w, data, sizeof(w));
+    HAL_FLASH_Unlock();
+    bool ok = (HAL_FLASH_Program(FLASH_TYPEPROGRAM_FLASHWORD, addr, (uint32_t)(uintptr_t)w) == HAL_OK);
+    HAL_FLASH_Lock();
+    return ok;
+#elif defined(HAL_FLASH_MODULE_ENABLED)
+    uint64_t v = 0;
+    uint32_t type;
+    switch (unit) {
+#ifdef FLASH_TYPEPROGRAM_HALFWORD
+    case 2: type = FLASH_TYPEPROGRAM_HALFWORD; break;
+#endif
+#ifdef FLASH_TYPEPROGRAM_WORD
+    case 4: type = FLASH_TYPEPROGRAM_WORD; break;
+#endif
+#ifdef FLASH_TYPEPROGRAM_DOUBLEWORD
+    case 8: type = FLASH_TYPEPROGRAM_DOUBLEWORD; break;
+#endif
+    default: return false;
+    }
+    memcpy(&v, data, unit);
+    HAL_FLASH_Unlock();
+    bool ok = (HAL_FLASH_Program(type, addr, v) == HAL_OK);
+    HAL_FLASH_Lock();
+    return ok;
+#else
+    (void)addr;
+    (void)data;
+    (void)unit;
+    return false;
+#endif
+}
+
+#if defined(HAL_FLASH_MODULE_ENABLED) && \
+    (defined(STM32F2xx) || defined(STM32F4xx) || defined(STM32F7xx) || defined(STM32H7xx))
+// ============ 扇区型 Flash：由地址求扇区号与扇区大小 ============
+// F2/F4/F7 每个 bank 的扇区为 4 x S、1 x 4S、之后每个 8S（S = 16K，F74x~F77x 为 32K）；
+// H7 每个 bank 的扇区大小一致（FLASH_SECTOR_SIZE）
+static void eefile_flash_sector(uintptr_t addr, uint32_t* sector, uint32_t* sectorSize, uint32_t* bank)
+{
+    uint32_t off = addr - FLASH_BASE;
+    *bank = 0;
+#if defined(STM32H7xx)
+#ifdef FLASH_BANK2_BASE
+    if (addr >= FLASH_BANK2_BASE) {
+        off = addr - FLASH_BANK2_BASE;
+        *bank = 1;
+    }
+#endif
+    *sectorSize = FLASH_SECTOR_SIZE;
+    *sector = off / FLASH_SECTOR_SIZE;
+#else
+#if defined(STM32F7xx) && !defined(STM32F722xx) && !defined(STM32F723xx) && \
+    !defined(STM32F730xx) && !defined(STM32F732xx) && !defined(STM32F733xx)
+    const uint32_t s = 0x8000;
+#else
+    const uint32_t s = 0x4000;
+#endif
+    uint32_t first = 0;
+#if defined(FLASH_SECTOR_12) && !defined(STM32F7xx)
+    // F42x/F43x 等双 bank 器件：第二个 bank 从 1MB 处开始，扇区号从 12 起
+    if (off >= 0x100000) {
+        off -= 0x100000;
+        first = 12;
+    }
+#endif
+    if (off < 4 * s) {
+        *sectorSize = s;
+        *sector = first + off / s;
+    } else if (off < 8 * s) {
+        *sectorSize = 4 * s;
+        *sector = first + 4;
+    } else {
+        *sectorSize = 8 * s;
+        *sector = first + 5 + (off - 8 * s) / (8 * s);
+    }
+#endif
+}
+#endif
+
+extern "C" __attribute__((weak))
+bool eefile_flash_erase(uintptr_t addr, uint32_t pageSize)
+{
+#if defined(HAL_FLASH_MODULE_ENABLED) && \
+    (defined(STM32F2xx) || defined(STM32F4xx) || defined(STM32F7xx) || defined(STM32H7xx))
+    // 扇区型器件：一页必须恰好是一个扇区，否则擦除会波及页外的数据
+    FLASH_EraseInitTypeDef erase;
+    uint32_t sectorError = 0;
+    uint32_t sector, sectorSize, bank;
+    eefile_flash_sector(addr, &sector, &sectorSize, &bank);
+    if (sectorSize != pageSize) {
+        return false;
+    }
+    memset(&erase, 0, sizeof(erase));
+    erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+    erase.Sector = sector;
+    erase.NbSectors = 1;
+    erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+#if defined(STM32H7xx)
+#ifdef FLASH_BANK_2
+    erase.Banks = bank ? FLASH_BANK_2 : FLASH_BANK_1;
+#else
+    (void)bank;
+    erase.Banks = FLASH_BANK_1;
+#endif
+#else
+    (void)bank;
+#endif
+    HAL_FLASH_Unlock();
+    bool ok = (HAL_FLASHEx_Erase(&erase, &sectorError) == HAL_OK);
+    HAL_FLASH_Lock();
+    return ok;
+#elif defined(HAL_FLASH_MODULE_ENABLED)
+    FLASH_EraseInitTypeDef erase;
+    uint32_t pageError = 0;
+    memset(&erase, 0, sizeof(erase));
+    erase.TypeErase = FLASH_TYPEERASE_PAGES;
+#if defined(STM32F0xx) || defined(STM32F1xx) || defined(STM32F3xx) || \
+    defined(STM32L0xx) || defined(STM32L1xx)
+    erase.PageAddress = addr;
+    (void)pageSize;
+#else
+    erase.Page = (addr - FLASH_BASE) / pageSize;
+#endif
+#ifdef FLASH_BANK_1
+    erase.Banks = FLASH_BANK_1;
+#endif
+    erase.NbPages = 1;
+    HAL_FLASH_Unlock();
+    bool ok = (HAL_FLASHEx_Erase(&erase, &pageError) == HAL_OK);
+    HAL_FLASH_Lock();
+    return ok;
+#else
+    (void)addr;
+    (void)pageSize;
+    return false;
+#endif
+}
+
+#endif
@@ -0,0 +1,103 @@
+/**
+ * @file eefile_flash.h
+ * @brief 原始片上 Flash 后端（STM32 / PY32 等按半字、字、双字编程的器件）
+ *
+ * 不经过厂商的 EEPROM 模拟层，直接在一段 Flash 上按原生宽度编程：
+ *   - 读：内存映射直接读取
+ *   - 写：按编程单位合并；目标单位为擦除态时直接编程，
+ *         否则把整页读入页缓冲、擦除后写回
+ * 配合 EEFILE_ALIGN = 编程单位，文件数据按单位对齐，一次写入的字节数
+ * 越多，省下的编程次数越多（半字 2 倍，双字 8 倍）。
+ *
+ * 编程/擦除通过弱符号 eefile_flash_program() / eefile_flash_erase() 完成，
+ * 默认实现使用 STM32 HAL；其它器件（如按页编程的 PY32）在应用中重新定义即可。
+ *
+ * 掉电风险：整页重写是"擦除 -> 逐单位写回"，两步之间掉电会丢失该页上
+ * 所有文件（不只是正在写的文件）。需要掉电安全时改用 EEPageBackend
+ * （eefile_pages.h），或只在不会掉电的时机修改已编程的数据。
+ */
+
+#ifndef __EEFILE_FLASH__
+#define __EEFILE_FLASH__
+
+#include "eefile_backend.h"
+
+// 使用原始 Flash 后端时定义为 1
+#ifndef EEFILE_FLASH
+#define EEFILE_FLASH 0
+#endif
+
+#if EEFILE_FLASH
+
+extern "C" {
+/**
+ * @brief 编程一个单位（unit 字节，地址已按 unit 对齐，目标为擦除态）
+ * @note 默认实现支持 2/4/8 字节；H7 只支持一个 Flash 字（32 字节，H7A3/B0 为 16 字节）
+ * @return 是否成功
+ */
+bool eefile_flash_program(uintptr_t addr, const uint8_t* data, uint16_t unit);
+
+/**
+ * @brief 擦除从 addr 开始的一页（扇区型器件为一个扇区）
+ */
+bool eefile_flash_erase(uintptr_t addr, uint32_t pageSize);
+}
+
+class EEFlashBackend : public EEBackend
+{
+  public:
+    /**
+     * @param base 区域起始地址（页对齐）
+     * @param size 区域大小（字节，页大小的整数倍；小于一页时区域独占该页开头，
+     *             页内其余部分在重写时会被擦除）
+     * @param pageSize 擦除页大小（扇区型器件为扇区大小，可达 128K）
+     * @param unit 编程单位：1/2/4/8 字节（H7 为 16/32 字节）
+     * @param pageBuf 页缓冲，至少 min(pageSize, size) 字节（擦除重写时使用）
+     * @param clearOverwrite 器件允许在已编程单位上只清零位时为 true
+     */
+    EEFlashBackend(uintptr_t base, uint16_t size, uint32_t pageSize, uint16_t unit,
+        uint8_t* pageBuf, bool clearOverwrite = false);
+
+    uint8_t read(uint16_t addr);
+    void write(uint16_t addr, uint8_t value);
+    void readBlock(uint16_t addr, uint8_t* buf, uint16_t len);
+    void writeBlock(uint16_t addr, const uint8_t* buf, uint16_t len);
+    uint16_t programUnit() const;
+
+    uint32_t getProgramCount() const;   // 编程操作次数（每次一个单位）
+    uint32_t getEraseCount() const;     // 页擦除次数
+    uint16_t getErrorCount() const;     // 编程/擦除失败次数
+
+  private:
+    uintptr_t base;
+    uint16_t size;
+    uint32_t pageSize;
+    uint16_t unit;
+    uint8_t* pageBuf;
+    bool clearOverwrite;
+    uint32_t programs;
+    uint32_t erases;
+    uint16_t errors;
+
+    bool program(uint16_t addr, const uint8_t* data);
+    uint16_t pageSpan(uint16_t page) const;
+    void rewritePage(uint16_t page, uint16_t addr, const uint8_t* buf, uint16_t len);
+};
+
+// 页缓冲大小：一页，区域小于一页时只需区域大小
+#define EEFILE_FLASH_PAGEBUF_SIZE(size, pageSize) \
+    ((uint32_t)(pageSize) < (uint32_t)(size) ? (uint32_t)(pageSize) : (uint32_t)(size))
+
+// 定义一个带页缓冲的 Flash 后端实例
+#define EEFILE_FLASH_BACKEND(name, base, size, pageSize, unit)          \
+    static uint8_t name##_pageBuf[EEFILE_FLASH_PAGEBUF_SIZE(size, pageSize)]; \
+    EEFlashBackend name(base, size, pageSize, unit, name##_pageBuf)
+
+// 同上，用于允许在已编程单位上只清零位的器件（WOM 编码等只清零位的写入不再擦除）
+#define EEFILE_FLASH_BACKEND_CLEAR(name, base, size, pageSize, unit)    \
+    static uint8_t name##_pageBuf[EEFILE_FLASH_PAGEBUF_SIZE(size, pageSize)]; \
+    EEFlashBackend name(base, size, pageSize, unit, name##_pageBuf, true)
+
+#endif
+
+#endif
@@ -0,0 +1,136 @@
+/**
+ * @file eefile_i2c.cpp
+ * @brief 外部 I2C EEPROM / FRAM 后端实现
+ */
+
+#include "eefile_i2c.h"
+
+#if EEFILE_I2C
+
+EEI2CBackend::EEI2CBackend(TwoWire& wire, uint8_t devAddr, uint16_t pageSize,
+    uint8_t addrBytes, uint8_t writeMs)
+    : wire(wire), devAddr(devAddr), pageSize(pageSize), addrBytes(addrBytes),
+      writeMs(writeMs), busy(false), busySince(0), errors(0)
+{
+}
+
+void EEI2CBackend::begin()
+{
+    wire.begin();
+}
+
+// ============ 寻址 ============
+// 单字节地址的小容量器件把地址第 8~10 位放在器件地址的低 3 位
+uint8_t EEI2CBackend::device(uint16_t addr) const
+{
+    return (addrBytes == 1) ? (devAddr | ((addr >> 8) & 0x07)) : devAddr;
+}
+
+void EEI2CBackend::sendAddr(uint16_t addr)
+{
+    wire.beginTransmission(device(addr));
+    if (addrBytes == 2) {
+        wire.write((uint8_t)(addr >> 8));
+    }
+    wire.write((uint8_t)(addr & 0xFF));
+}
+
+// ============ 写周期：ACK 轮询 ============
+bool EEI2CBackend::isBusy(void)
+{
+    if (!busy) {
+        return false;
+    }
+    wire.beginTransmission(devAddr);
+    if (wire.endTransmission() == 0) {
+        busy = false;
+    } else if (millis() - busySince > (uint32_t)writeMs * 2) {
+        FILE_DEBUG("[EEI2C] ERROR: device 0x%02X not responding", devAddr);
+        errors++;
+        busy = false;
+    }
+    return busy;
+}
+
+void EEI2CBackend::waitReady(void)
+{
+    while (isBusy()) {
+    }
+}
+
+// ============ 读 ============
+uint8_t EEI2CBackend::read(uint16_t addr)
+{
+    uint8_t v;
+    readBlock(addr, &v, 1);
+    return v;
+}
+
+void EEI2CBackend::readBlock(uint16_t addr, uint8_t* buf, uint16_t len)
+{
+    waitReady();
+    while (len > 0) {
+        uint8_t n = (len > EEFILE_I2C_CHUNK) ? EEFILE_I2C_CHUNK : len;
+        sendAddr(addr);
+        uint8_t got = 0;
+        if (wire.endTransmission(false) == 0) {
+            got = wire.requestFrom(device(addr), n);
+        }
+        for (uint8_t i = 0; i < n; i++) {
+            buf[i] = (i < got) ? wire.read() : 0xFF;
+        }
+        if (got < n) {
+            errors++;
+        }
+        buf += n;
+        addr += n;
+        len -= n;
+    }
+}
+
+// ============ 写：按页分段，最后一段不等待写周期 ============
+void EEI2CBackend::write(uint16_t addr, uint8_t value)
+{
+    writeBlock(addr, &value, 1);
+}
+
+void EEI2CBackend::writeBlock(uint16_t addr, const uint8_t* buf, uint16_t len)
+{
+    while (len > 0) {
+        uint16_t n = pageSize - addr % pageSize;
+        if (n > EEFILE_I2C_CHUNK) {
+            n = EEFILE_I2C_CHUNK;
+        }
+        if (n > len) {
+            n = len;
+        }
+        waitReady();
+        sendAddr(addr);
+        wire.write(buf, n);
+        if (wire.endTransmission() != 0) {
+            FILE_DEBUG("[EEI2C] ERROR: write 0x%04X NACK", addr);
+            errors++;
+        }
+        if (writeMs) {
+            busy = true;
+            busySince = millis();
+        }
+        buf += n;
+        addr += n;
+        len -= n;
+    }
+}
+
+// 每次页写都有一个写周期（FRAM 也有一次总线事务）：一段变化合并成一次写入，
+// 而不是每字节一个周期
+bool EEI2CBackend::coalesceWrites() const
+{
+    return true;
+}
+
+uint16_t EEI2CBackend::getErrorCount() const
+{
+    return errors;
+}
+
+#endif
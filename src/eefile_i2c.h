@@ -0,0 +1,70 @@
+/**
+ * @file eefile_i2c.h
+ * @brief 外部 I2C EEPROM / FRAM 后端（24Cxx、MB85RC 等）
+ *
+ * 按器件页大小分段写入。每段写完后器件进入内部写周期（24Cxx 约 5 ms），
+ * 本后端不原地等待，而是在下一次访问器件前用 ACK 轮询确认就绪。
+ * 因此写入一结束即可去操作另一个器件（如镜像模式下的片内 EEPROM），
+ * 两边的写周期重叠进行。FRAM 没有写周期，writeMs 取 0。
+ */
+
+#ifndef __EEFILE_I2C__
+#define __EEFILE_I2C__
+
+#include "eefile_backend.h"
+
+// 使用 I2C 后端时定义为 1（会引入 Wire 库）
+#ifndef EEFILE_I2C
+#define EEFILE_I2C 0
+#endif
+
+#if EEFILE_I2C
+
+#include "Wire.h"
+
+// 每次 I2C 传输的最大数据字节数（AVR 的 Wire 缓冲为 32 字节，含地址）
+#ifndef EEFILE_I2C_CHUNK
+#define EEFILE_I2C_CHUNK 16
+#endif
+
+class EEI2CBackend : public EEBackend
+{
+  public:
+    /**
+     * @param wire I2C 总线
+     * @param devAddr 7 位器件地址（24Cxx 通常为 0x50）
+     * @param pageSize 器件页大小（24C02 为 8，24C32 为 32，FRAM 可取任意值）
+     * @param addrBytes 地址字节数：24C01~24C16 为 1（高位地址放在器件地址中），更大容量为 2
+     * @param writeMs 写周期上限（毫秒），FRAM 为 0
+     */
+    EEI2CBackend(TwoWire& wire, uint8_t devAddr, uint16_t pageSize,
+        uint8_t addrBytes = 2, uint8_t writeMs = 5);
+
+    void begin();
+    uint8_t read(uint16_t addr);
+    void write(uint16_t addr, uint8_t value);
+    void readBlock(uint16_t addr, uint8_t* buf, uint16_t len);
+    void writeBlock(uint16_t addr, const uint8_t* buf, uint16_t len);
+    bool coalesceWrites() const;
+
+    bool isBusy(void);                  // 器件是否仍在内部写周期中
+    uint16_t getErrorCount() const;     // 无应答 / 超时次数
+
+  private:
+    TwoWire& wire;
+    uint8_t devAddr;
+    uint16_t pageSize;
+    uint8_t addrBytes;
+    uint8_t writeMs;
+    bool busy;
+    uint32_t busySince;
+    uint16_t errors;
+
+    uint8_t device(uint16_t addr) const;
+    void sendAddr(uint16_t addr);
+    void waitReady(void);
+};
+
+#endif
+
+#endif
@@ -0,0 +1,1860 @@
+/**
+ * @file eefile_impl.h
+ * @brief EEFileT 的成员定义
+ *
+ * 默认实例 EEFILE 已在 eefile.cpp 中显式实例化，普通用户无需包含本文件。
+ * 自定义后端 / 布局 / 文件类型的实例化须在某一个 .cpp 中包含本文件：
+ *   #include "eefile_impl.h"
+ *   enum class BootFile : uint8_t { CONFIG, COUNTER, END };
+ *   template class EEFileT<EEPROMBackend, MyLayout, BootFile>;
+ */
+
+#ifndef __EEFILE_IMPL__
+#define __EEFILE_IMPL__
+
+#include "eefile.h"
+#if EEFILE_POLICY
+#include "eefile_policy.h"
+#endif
+// #include "Debug.h"
+#include <cstdarg>
+
+// ============ 公共接口的统一出入口（用户钩子 / 轨迹 / 最坏执行时间）============
+#if EEFILE_WCET
+#define EE_OP_BEGIN(op, type, len) \
+    EEFILE_HOOK_OP_PRE(op, type, len); uint32_t opStart = EEFILE_CYCLES()
+#define EE_OP_CYCLES()  (EEFILE_CYCLES() - opStart)
+#else
+#define EE_OP_BEGIN(op, type, len)  EEFILE_HOOK_OP_PRE(op, type, len)
+#define EE_OP_CYCLES()  0
+#endif
+
+#if EEFILE_TRACE || EEFILE_WCET
+#define EE_OP_END(op, type, len, ok) \
+    do { opDone(op, type, len, ok, EE_OP_CYCLES()); EEFILE_HOOK_OP_POST(op, type, len, ok); } while (0)
+#else
+#define EE_OP_END(op, type, len, ok)  EEFILE_HOOK_OP_POST(op, type, len, ok)
+#endif
+
+// ============ 布局常量（类内初始化，这里只提供定义）============
+template <class Backend, class Layout, class FileType> const uint8_t EEFileT<Backend, Layout, FileType>::MAX_FILES;
+template <class Backend, class Layout, class FileType> const uint8_t EEFileT<Backend, Layout, FileType>::NO_FILE;
+template <class Backend, class Layout, class FileType> const uint16_t EEFileT<Backend, Layout, FileType>::TOTAL_SIZE;
+template <class Backend, class Layout, class FileType> const uint16_t EEFileT<Backend, Layout, FileType>::AREA_END;
+template <class Backend, class Layout, class FileType> const uint16_t EEFileT<Backend, Layout, FileType>::DATA_SIZE;
+#if EEFILE_VALID_BITMAP
+template <class Backend, class Layout, class FileType> const uint8_t EEFileT<Backend, Layout, FileType>::VBM_BYTES;
+template <class Backend, class Layout, class FileType> const uint8_t EEFileT<Backend, Layout, FileType>::VBM_SLOT_SIZE;
+template <class Backend, class Layout, class FileType> const uint16_t EEFileT<Backend, Layout, FileType>::VBM_ADDR;
+#endif
+#if EEFILE_VERIFY
+template <class Backend, class Layout, class FileType> const uint16_t EEFileT<Backend, Layout, FileType>::REMAP_ADDR;
+template <class Backend, class Layout, class FileType> const uint16_t EEFileT<Backend, Layout, FileType>::SPARE_ADDR;
+#endif
+
+// ============ 通过枚举查找文件索引 ============
+template <class Backend, class Layout, class FileType>
+uint8_t EEFileT<Backend, Layout, FileType>::findFileIndex(FileType type)
+{
+    return ((uint8_t)type < MAX_FILES) ? fileIndex[(uint8_t)type] : NO_FILE;
+}
+
+// ============ 计算下一个可用地址 ============
+template <class Backend, class Layout, class FileType>
+uint16_t EEFileT<Backend, Layout, FileType>::calculateNextAddr(void)
+{
+    if (fileCount == 0) {
+        return 0;  // 从 0 开始
+    }
+
+    // 获取最后一个文件的结束地址
+    uint16_t lastEnd = files[fileCount - 1].endAddr;
+
+    // 下一个文件从最后一个文件的结束地址 + 1 开始
+    return lastEnd + 1;
+}
+
+// ============ CRC16-CCITT（多项式 0x1021，初值 0xFFFF）============
+template <class Backend, class Layout, class FileType>
+uint16_t EEFileT<Backend, Layout, FileType>::calculateCRC(const uint8_t* data, uint16_t length)
+{
+    uint16_t crc = 0xFFFF;
+    for (uint16_t i = 0; i < length; i++) {
+        crc = eep_crc16_update(crc, data[i]);
+    }
+    return crc;
+}
+
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::verifyCRC(const uint8_t* data, uint16_t length, uint16_t crc)
+{
+    return calculateCRC(data, length) == crc;
+}
+
+#if EEFILE_WRITE_HASH
+// ============ 写入内容哈希（FNV-1a，覆盖数据和 0xFF 填充）============
+template <class Backend, class Layout, class FileType>
+uint32_t EEFileT<Backend, Layout, FileType>::contentHash(const uint8_t* data, uint16_t len, uint16_t total)
+{
+    uint32_t h = 2166136261UL;
+    for (uint16_t i = 0; i < total; i++) {
+        h = (h ^ ((i < len) ? data[i] : 0xFF)) * 16777619UL;
+    }
+    return h;
+}
+
+// 内容是否与器件上的有效内容相同：哈希不同或尚未建立时直接判定为不同
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::sameContent(uint8_t idx, const uint8_t* data, uint16_t len, uint32_t hash)
+{
+    if (!files[idx].hashKnown || files[idx].hash != hash || !markerValid(idx)) {
+        return false;
+    }
+#if EEFILE_HASH_CONFIRM
+    // 哈希相同：读回确认，排除碰撞
+    uint8_t buf[16];
+    uint16_t dataAddr = files[idx].startAddr + EEFILE_MARKER_SIZE;
+    for (uint16_t off = 0; off < files[idx].maxSize; off += sizeof(buf)) {
+        uint16_t n = files[idx].maxSize - off;
+        if (n > sizeof(buf)) {
+            n = sizeof(buf);
+        }
+        ioReadBlock(dataAddr + off, buf, n);
+        for (uint16_t i = 0; i < n; i++) {
+            if (buf[i] != ((off + i < len) ? data[off + i] : 0xFF)) {
+                return false;
+            }
+        }
+    }
+#else
+    (void)data;
+    (void)len;
+#endif
+    return true;
+}
+
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::forgetHashes(void)
+{
+    for (uint8_t i = 0; i < fileCount; i++) {
+        files[i].hashKnown = false;
+    }
+}
+#endif
+
+// ============ 差分写单字节 ============
+// 内容相同则跳过编程（减少磨损），返回是否真正写入
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::updateByte(uint8_t idx, uint16_t addr, uint8_t value)
+{
+    if (ioRead(addr) == value) {
+        return false;
+    }
+    ioWrite(addr, value);
+    stats.bytesProgrammed++;
+#if EEFILE_VERIFY
+    if (ioRead(addr) != value) {
+        verifyFailed = true;
+    }
+#endif
+#if EEFILE_SYNC
+    markDirty(idx, addr);
+#else
+    (void)idx;
+#endif
+    return true;
+}
+
+// ============ 差分写一段数据 ============
+// 按 16 字节分块比较。字节编程的后端只写变化的字节；按单位编程或页写的后端
+// （coalesceWrites()）每块只提交一次“首个变化字节 ~ 最后变化字节”，由后端合并成原生宽度编程。
+// 写入 data 的 len 字节，之后到 total 字节填充 0xFF，返回变化的字节数
+template <class Backend, class Layout, class FileType>
+uint16_t EEFileT<Backend, Layout, FileType>::updateBlock(uint8_t idx, uint16_t addr, const uint8_t* data, uint16_t len, uint16_t total)
+{
+    uint8_t old[16];
+    uint8_t src[16];
+    bool bytewise = !backend->coalesceWrites();
+    uint16_t changed = 0;
+
+    for (uint16_t off = 0; off < total; off += sizeof(old)) {
+        uint16_t n = total - off;
+        if (n > sizeof(old)) {
+            n = sizeof(old);
+        }
+        int16_t first = -1;
+        int16_t last = -1;
+
+        for (uint16_t i = 0; i < n; i++) {
+            src[i] = (off + i < len) ? data[off + i] : 0xFF;
+        }
+        ioReadBlock(addr + off, old, n);
+        for (uint16_t i = 0; i < n; i++) {
+            if (old[i] == src[i]) {
+                continue;
+            }
+#if EEFILE_MONOTONIC_MARKER
+            // 第一个要编程的字节：先把标记切到“写入中”
+            if (markerArm == idx) {
+                markerArm = NO_FILE;
+                markerBeginWrite(idx);
+            }
+#endif
+            if (bytewise) {
+                ioWrite(addr + off + i, src[i]);
+            }
+            if (first < 0) {
+                first = i;
+            }
+            last = i;
+            changed++;
+        }
+        if (first < 0) {
+            continue;
+        }
+        if (!bytewise) {
+            ioWriteBlock(addr + off + first, src + first, last - first + 1);
+        }
+#if EEFILE_VERIFY
+        // 读回变化的部分，与写入内容整块比较
+        ioReadBlock(addr + off + first, old + first, last - first + 1);
+        if (memcmp(old + first, src + first, last - first + 1) != 0) {
+            verifyFailed = true;
+        }
+#endif
+#if EEFILE_SYNC
+        markDirty(idx, addr + off + first);
+        markDirty(idx, addr + off + last);
+#endif
+    }
+    (void)idx;
+
+    stats.bytesProgrammed += changed;
+    return changed;
+}
+
+#if EEFILE_SYNC
+// ============ 同步区间：下标 0..fileCount-1 为文件，其后依次为位图槽区域、备用区和重映射表 ============
+template <class Backend, class Layout, class FileType>
+EESyncRange* EEFileT<Backend, Layout, FileType>::syncRange(uint8_t idx)
+{
+#if EEFILE_VALID_BITMAP
+    if (idx == fileCount) {
+        return &vbmSync;
+    }
+#endif
+#if EEFILE_VERIFY
+    if (idx >= fileCount) {
+        return &remapSync;
+    }
+#endif
+    return &files[idx].sync;
+}
+
+template <class Backend, class Layout, class FileType>
+uint8_t EEFileT<Backend, Layout, FileType>::syncRangeCount(void) const
+{
+    uint8_t n = fileCount;
+#if EEFILE_VALID_BITMAP
+    n++;
+#endif
+#if EEFILE_VERIFY
+    n++;
+#endif
+    return n;
+}
+
+// ============ 记录待同步的脏区间 ============
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::markDirty(uint8_t idx, uint16_t addr)
+{
+    EESyncRange &r = *syncRange(idx);
+    if (r.lo > r.hi) {
+        r.lo = r.hi = addr;
+    } else if (addr < r.lo) {
+        r.lo = addr;
+    } else if (addr > r.hi) {
+        r.hi = addr;
+    }
+}
+#endif
+
+#if EEFILE_VERIFY
+// ============ 坏区重映射表 ============
+// 条目只追加不修改，同一原地址有多条时以最后一条为准；原地址 0xFFFF 表示空条目
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::remapEntry(uint8_t slot, uint16_t* from, uint16_t* to, uint16_t* len)
+{
+    uint8_t e[EEFILE_REMAP_ENTRY_SIZE];
+    ioReadBlock(REMAP_ADDR + slot * EEFILE_REMAP_ENTRY_SIZE, e, sizeof(e));
+    *from = eep_get_u16(e);
+    *to = eep_get_u16(e + 2);
+    *len = eep_get_u16(e + 4);
+    return *from != 0xFFFF && e[6] == (uint8_t)calculateCRC(e, 6) &&
+           *to >= SPARE_ADDR && *len <= REMAP_ADDR - *to;
+}
+
+// 上电时读取一次：已用条目数、备用区的使用位置，表项缓存到 RAM，注册时不再访问存储
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::remapLoad(void)
+{
+    uint16_t from, to, len;
+    remapUsed = 0;
+    spareNext = SPARE_ADDR;
+    while (remapUsed < EEFILE_REMAP_SLOTS) {
+        bool ok = remapEntry(remapUsed, &from, &to, &len);
+        if (!ok && from == 0xFFFF) {
+            break;
+        }
+        remapFrom[remapUsed] = ok ? from : 0xFFFF;
+        remapTo[remapUsed] = to;
+        remapUsed++;
+        if (ok && to + len > spareNext) {
+            spareNext = to + len;
+        }
+    }
+    if (remapUsed > 0) {
+        FILE_DEBUG("[EE] Remap table: %d entries, spare %d/%d bytes used",
+            remapUsed, spareNext - SPARE_ADDR, EEFILE_SPARE_SIZE);
+    }
+
+    // begin() 之前已注册的文件按新表更新起始地址
+    for (uint8_t i = 0; i < fileCount; i++) {
+        uint16_t size = EEFILE_ALIGN_UP(files[i].maxSize) + EEFILE_MARKER_SIZE;
+        files[i].startAddr = remapLookup(files[i].endAddr + 1 - size);
+    }
+}
+
+// 注册时调用：返回文件的实际起始地址（只查 RAM 缓存）
+template <class Backend, class Layout, class FileType>
+uint16_t EEFileT<Backend, Layout, FileType>::remapLookup(uint16_t from)
+{
+    uint16_t addr = from;
+    for (uint8_t i = 0; i < remapUsed; i++) {
+        if (remapFrom[i] == from) {
+            addr = remapTo[i];
+        }
+    }
+    return addr;
+}
+
+// 写入读回不一致：把文件（标记 + 数据）复制到备用区，复制无误后才追加表项，
+// 之后由调用者在新位置重写。备用区某段也损坏时跳过它继续尝试
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::remapFile(uint8_t idx)
+{
+    uint16_t size = EEFILE_ALIGN_UP(files[idx].maxSize) + EEFILE_MARKER_SIZE;
+    uint16_t from = files[idx].endAddr + 1 - size;
+    uint8_t buf[16];
+
+    // 备用区和表项记在自己的同步区间下，不算作该文件的脏数据
+    uint8_t area = fileCount;
+#if EEFILE_VALID_BITMAP
+    area++;
+#endif
+
+    stats.verifyFailures++;
+    FILE_DEBUG("[EE] WARNING: Type %d verify failed at 0x%04X", files[idx].type, files[idx].startAddr);
+    while (spareNext + size <= REMAP_ADDR) {
+        uint16_t to = spareNext;
+        spareNext += size;
+        verifyFailed = false;
+        for (uint16_t off = 0; off < size; off += sizeof(buf)) {
+            uint16_t n = size - off;
+            if (n > sizeof(buf)) {
+                n = sizeof(buf);
+            }
+            ioReadBlock(files[idx].startAddr + off, buf, n);
+            updateBlock(area, to + off, buf, n, n);
+        }
+        if (verifyFailed) {
+            continue;
+        }
+
+        uint8_t e[EEFILE_REMAP_ENTRY_SIZE];
+        eep_put_u16(e, from);
+        eep_put_u16(e + 2, to);
+        eep_put_u16(e + 4, size);
+        e[6] = (uint8_t)calculateCRC(e, 6);
+        while (remapUsed < EEFILE_REMAP_SLOTS) {
+            verifyFailed = false;
+            updateBlock(area, REMAP_ADDR + remapUsed * EEFILE_REMAP_ENTRY_SIZE, e, sizeof(e), sizeof(e));
+            remapFrom[remapUsed] = verifyFailed ? 0xFFFF : from;
+            remapTo[remapUsed] = to;
+            remapUsed++;
+            if (!verifyFailed) {
+                files[idx].startAddr = to;
+#if !EEFILE_VALID_BITMAP
+                files[idx].marker = EE_MARKER_UNKNOWN;
+#endif
+#if EEFILE_WRITE_HASH
+                files[idx].hashKnown = false;
+#endif
+#if EEFILE_SYNC
+                // 旧位置已废弃，副本在备用区的同步区间里，文件区间从新位置重新记起
+                files[idx].sync.lo = 0xFFFF;
+                files[idx].sync.hi = 0;
+#endif
+                stats.remaps++;
+                FILE_DEBUG("[EE] Type %d remapped 0x%04X -> 0x%04X", files[idx].type, from, to);
+                return true;
+            }
+        }
+        break;
+    }
+    FILE_DEBUG("[EE] ERROR: Type %d has bad cells and no spare left", files[idx].type);
+    stats.errors++;
+    return false;
+}
+#endif
+
+// ============ 有效性标记读写 ============
+// 标记状态缓存在内存中：首次访问时读取一次，状态未变时不再访问 EEPROM
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::markerValid(uint8_t idx)
+{
+#if EEFILE_VALID_BITMAP
+    return (vbm[idx >> 3] >> (idx & 7)) & 1;
+#else
+    return markerState(idx) == EE_MARKER_VALID;
+#endif
+}
+
+#if !EEFILE_VALID_BITMAP
+template <class Backend, class Layout, class FileType>
+uint8_t EEFileT<Backend, Layout, FileType>::markerState(uint8_t idx)
+{
+    if (files[idx].marker == EE_MARKER_UNKNOWN) {
+        uint8_t raw = ioRead(files[idx].startAddr);
+#if EEFILE_MONOTONIC_MARKER
+        // 合法编码是低位连续清零：清零位数为奇数是写入中，偶数是有效
+        files[idx].marker = EE_MARKER_TORN;
+        files[idx].markerGen = 0;
+        if (raw == EEFILE_MARK_ERASED) {
+            files[idx].marker = EE_MARKER_ERASED;
+        } else if (raw == EEFILE_MARK_INVALID) {
+            files[idx].marker = EE_MARKER_INVALID;
+        } else {
+            for (uint8_t g = 1; g <= EEFILE_MARK_GENS; g++) {
+                if (raw == EEFILE_MARK_WRITING(g) || raw == EEFILE_MARK_VALID(g)) {
+                    files[idx].marker = (raw == EEFILE_MARK_VALID(g)) ? EE_MARKER_VALID : EE_MARKER_WRITING;
+                    files[idx].markerGen = g;
+                    break;
+                }
+            }
+        }
+        // 标记停在“写入中”或不是合法编码，说明上次写入被掉电打断
+        if (files[idx].marker == EE_MARKER_WRITING || files[idx].marker == EE_MARKER_TORN) {
+            FILE_DEBUG("[EE] WARNING: Type %d torn write detected (marker: 0x%02X)",
+                files[idx].type, raw);
+            stats.errors++;
+        }
+#else
+        files[idx].marker = (raw == 0x01) ? EE_MARKER_VALID : EE_MARKER_INVALID;
+#endif
+    }
+    return files[idx].marker;
+}
+
+// 把标记写成指定状态并更新缓存（单调标记按 files[idx].markerGen 取当前代的编码）
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::markerProgram(uint8_t idx, uint8_t state)
+{
+#if EEFILE_MONOTONIC_MARKER
+    uint8_t gen = files[idx].markerGen;
+    uint8_t raw = EEFILE_MARK_INVALID;
+    if (state == EE_MARKER_ERASED) {
+        raw = EEFILE_MARK_ERASED;
+    } else if (state == EE_MARKER_WRITING) {
+        raw = EEFILE_MARK_WRITING(gen);
+    } else if (state == EE_MARKER_VALID) {
+        raw = EEFILE_MARK_VALID(gen);
+    }
+#else
+    uint8_t raw = (state == EE_MARKER_VALID) ? 0x01 : 0x00;
+#endif
+    if (updateByte(idx, files[idx].startAddr, raw)) {
+        stats.markerWrites++;
+    }
+    files[idx].marker = state;
+}
+#endif
+
+#if EEFILE_MONOTONIC_MARKER
+// ============ 单调标记：内容即将改变 ============
+// 由 updateBlock 在第一个真正要编程的字节之前调用：有效的第 g 代进入第 g+1 代“写入中”，
+// 只清零位；代数用完、已失效或撕裂时先回到擦除态。已在写入中（上次被打断）则保持不动
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::markerBeginWrite(uint8_t idx)
+{
+    uint8_t state = markerState(idx);
+    if (state == EE_MARKER_WRITING) {
+        return;
+    }
+    if (state == EE_MARKER_VALID && files[idx].markerGen < EEFILE_MARK_GENS) {
+        files[idx].markerGen++;
+    } else {
+        if (state != EE_MARKER_ERASED) {
+            markerProgram(idx, EE_MARKER_ERASED);
+        }
+        files[idx].markerGen = 1;
+    }
+    markerProgram(idx, EE_MARKER_WRITING);
+}
+#endif
+
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::setMarker(uint8_t idx, bool valid)
+{
+#if EEFILE_VALID_BITMAP
+    if (vbmSetBit(idx, valid)) {
+        vbmCommit();
+    } else {
+        stats.markerSkips++;
+    }
+#elif EEFILE_MONOTONIC_MARKER
+    // 置无效只清零位；置有效只能从擦除态（进入第 1 代）或写入中（同一代）出发，
+    // 已失效（或撕裂）的标记要先回到擦除态（Flash 上即一次擦除）
+    uint8_t state = markerState(idx);
+    if (valid) {
+        if (state == EE_MARKER_VALID) {
+            stats.markerSkips++;
+            return;
+        }
+        if (state != EE_MARKER_WRITING) {
+            if (state != EE_MARKER_ERASED) {
+                markerProgram(idx, EE_MARKER_ERASED);
+            }
+            files[idx].markerGen = 1;
+        }
+        markerProgram(idx, EE_MARKER_VALID);
+    } else {
+        if (state == EE_MARKER_INVALID || state == EE_MARKER_ERASED) {
+            stats.markerSkips++;
+            return;
+        }
+        markerProgram(idx, EE_MARKER_INVALID);
+    }
+#else
+    if (markerValid(idx) == valid) {
+        stats.markerSkips++;
+        return;
+    }
+    markerProgram(idx, valid ? EE_MARKER_VALID : EE_MARKER_INVALID);
+#endif
+}
+
+#if EEFILE_VALID_BITMAP
+// ============ 共享有效位图 ============
+// 槽格式：[序号][位图 VBM_BYTES][校验 = 0x5A ^ 序号 ^ 各位图字节]
+// 每次提交写入下一个槽、序号加一；上电时找到“后继槽不是序号+1”的有效槽即为最新。
+// 校验最后写入，掉电写坏的槽校验不通过，自动回退到上一个槽。
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::vbmSetBit(uint8_t idx, bool valid)
+{
+    uint8_t mask = (uint8_t)(1 << (idx & 7));
+    uint8_t old = vbm[idx >> 3];
+    vbm[idx >> 3] = valid ? (old | mask) : (old & ~mask);
+    return vbm[idx >> 3] != old;
+}
+
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::vbmReadSlot(uint8_t slot, uint8_t* seq, uint8_t* bits)
+{
+    uint8_t raw[VBM_SLOT_SIZE];
+    ioReadBlock(VBM_ADDR + slot * VBM_SLOT_SIZE, raw, sizeof(raw));
+    uint8_t check = 0x5A;
+    for (uint8_t i = 0; i < VBM_SLOT_SIZE - 1; i++) {
+        check ^= raw[i];
+    }
+    if (check != raw[VBM_SLOT_SIZE - 1]) {
+        return false;
+    }
+    *seq = raw[0];
+    if (bits) {
+        memcpy(bits, raw + 1, VBM_BYTES);
+    }
+    return true;
+}
+
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::vbmLoad(void)
+{
+    uint8_t seq, nextSeq;
+    int8_t best = -1;
+    for (uint8_t i = 0; i < EEFILE_VBM_SLOTS; i++) {
+        if (!vbmReadSlot(i, &seq, NULL)) {
+            continue;
+        }
+        uint8_t next = (i + 1) % EEFILE_VBM_SLOTS;
+        if (vbmReadSlot(next, &nextSeq, NULL) && nextSeq == (uint8_t)(seq + 1)) {
+            continue;
+        }
+        // 链尾可能不止一个（中间有坏槽被跳过），取序号最新的
+        if (best < 0 || (int8_t)(seq - vbmSeq) > 0) {
+            best = i;
+            vbmSeq = seq;
+        }
+    }
+    if (best >= 0) {
+        vbmReadSlot(best, &seq, vbm);
+        vbmSlot = best;
+        FILE_DEBUG("[EE] Valid bitmap: slot %d, seq %d", best, seq);
+        return;
+    }
+
+    // 没有有效槽（新芯片或首次启用位图）：全部无效，下一次提交写槽 0
+    memset(vbm, 0, sizeof(vbm));
+    vbmSlot = EEFILE_VBM_SLOTS - 1;
+    vbmSeq = 0xFF;
+    FILE_DEBUG("[EE] Valid bitmap: empty");
+}
+
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::vbmCommit(void)
+{
+#if EEFILE_VERIFY
+    // 槽读回不一致只换下一槽重写，不能算到用户文件头上触发重映射
+    bool fileFailed = verifyFailed;
+#endif
+    for (uint8_t attempt = 0; attempt < EEFILE_VBM_SLOTS - 1; attempt++) {
+        uint8_t slot = (vbmSlot + 1) % EEFILE_VBM_SLOTS;
+        uint8_t seq = vbmSeq + 1;
+        uint16_t addr = VBM_ADDR + slot * VBM_SLOT_SIZE;
+
+        // 按顺序写入，校验字节在最后
+        uint8_t raw[VBM_SLOT_SIZE];
+        raw[0] = seq;
+        raw[VBM_SLOT_SIZE - 1] = 0x5A ^ seq;
+        for (uint8_t i = 0; i < VBM_BYTES; i++) {
+            raw[1 + i] = vbm[i];
+            raw[VBM_SLOT_SIZE - 1] ^= vbm[i];
+        }
+#if EEFILE_VERIFY
+        verifyFailed = false;
+#endif
+        stats.markerWrites += updateBlock(fileCount, addr, raw, sizeof(raw), sizeof(raw));
+
+        // 坏槽也占用序号，后面的槽接着递增，上电时按序号取最新
+        vbmSlot = slot;
+        vbmSeq = seq;
+#if EEFILE_VERIFY
+        if (verifyFailed) {
+            stats.verifyFailures++;
+            FILE_DEBUG("[EE] WARNING: Valid bitmap slot %d verify failed", slot);
+            continue;
+        }
+        verifyFailed = fileFailed;
+#endif
+        return;
+    }
+#if EEFILE_VERIFY
+    verifyFailed = fileFailed;
+#endif
+    FILE_DEBUG("[EE] ERROR: Valid bitmap could not be committed");
+    stats.errors++;
+}
+#endif
+
+// ============ Constructor ============
+template <class Backend, class Layout, class FileType>
+EEFileT<Backend, Layout, FileType>::EEFileT()
+    : fileCount(0), is_enabled(false), backend(EEBackendDefault<Backend>::get())
+{
+    memset(files, 0, sizeof(files));
+    memset(fileIndex, NO_FILE, sizeof(fileIndex));
+    memset(&stats, 0, sizeof(stats));
+#if EEFILE_VALID_BITMAP
+    memset(vbm, 0, sizeof(vbm));
+    vbmSlot = EEFILE_VBM_SLOTS - 1;
+    vbmSeq = 0xFF;
+#if EEFILE_SYNC
+    vbmSync.lo = vbmSync.sentLo = 0xFFFF;
+    vbmSync.hi = vbmSync.sentHi = 0;
+#endif
+#endif
+#if EEFILE_SYNC && EEFILE_VERIFY
+    remapSync.lo = remapSync.sentLo = 0xFFFF;
+    remapSync.hi = remapSync.sentHi = 0;
+#endif
+#if EEFILE_TRACE
+    traceHead = 0;
+    traceCount = 0;
+    traceDropped = 0;
+    traceLastMs = 0;
+#endif
+#if EEFILE_VERIFY
+    verifyFailed = false;
+    remapUsed = 0;
+    spareNext = SPARE_ADDR;
+#endif
+#if EEFILE_MONOTONIC_MARKER
+    markerArm = NO_FILE;
+#endif
+#if EEFILE_WCET
+    memset(wcetMax, 0, sizeof(wcetMax));
+    memset(wcetBound, 0, sizeof(wcetBound));
+    wcetOverruns = 0;
+#endif
+}
+
+// ============ 更换存储后端 ============
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::setBackend(Backend &b)
+{
+    backend = &b;
+#if EEFILE_WRITE_HASH
+    forgetHashes();
+#endif
+}
+
+// ============ 初始化 EEPROM ============
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::begin()
+{
+    EE_OP_BEGIN(EEP_OP_BEGIN, (FileType)0, 0);
+    if (!backend) {
+        FILE_DEBUG("[EEFILE] ERROR: No backend, call setBackend() before begin()");
+        EE_OP_END(EEP_OP_BEGIN, (FileType)0, 0, false);
+        return;
+    }
+    backend->begin();
+#if EEFILE_WRITE_HASH
+    forgetHashes();
+#endif
+#if EEFILE_VERIFY
+    remapLoad();
+#endif
+#if EEFILE_VALID_BITMAP
+    backend->mapRegion(MAX_FILES, VBM_ADDR, TOTAL_SIZE - VBM_ADDR,
+        EEFILE_TIER_SLOW);
+    vbmLoad();
+#endif
+    is_enabled = true;
+    FILE_DEBUG("[EEFILE] EEPROM initialized");
+    FILE_DEBUG("[EEFILE] Total: %d bytes (%d sectors × %d)",
+        TOTAL_SIZE, Layout::NUM_SECTORS, Layout::SECTOR_SIZE);
+    EE_OP_END(EEP_OP_BEGIN, (FileType)0, 0, true);
+}
+
+// ============ 延迟挂载：推迟的工作 ============
+// 逐文件标记未读取、或策略尚未挂载即视为未校验；共享位图模式下标记在 begin() 中已全部读出
+template <class Backend, class Layout, class FileType>
+uint32_t EEFileT<Backend, Layout, FileType>::getDeferredMask(void) const
+{
+    uint32_t mask = 0;
+    for (uint8_t i = 0; i < fileCount && i < 32; i++) {
+        bool deferred = false;
+#if !EEFILE_VALID_BITMAP
+        deferred = (files[i].marker == EE_MARKER_UNKNOWN);
+#endif
+#if EEFILE_POLICY
+        deferred = deferred || (files[i].policy && !files[i].policy->mounted);
+#endif
+        if (deferred) {
+            mask |= (uint32_t)1 << i;
+        }
+    }
+    return mask;
+}
+
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::service(void)
+{
+    for (uint8_t i = 0; i < fileCount; i++) {
+#if EEFILE_POLICY
+        if (files[i].policy && !files[i].policy->mounted) {
+            policyOf(i);
+            break;
+        }
+#endif
+#if !EEFILE_VALID_BITMAP
+        if (files[i].marker == EE_MARKER_UNKNOWN) {
+            markerState(i);
+            break;
+        }
+#endif
+    }
+#if EEFILE_POLICY
+    // 写回到期的回写缓存
+    bool wrote = false;
+    for (uint8_t i = 0; i < fileCount; i++) {
+        EEPolicy* p = files[i].policy;
+        if (p && p->mounted && p->dirty && p->ops->flush) {
+            EEPolicyPort<EEFileT> io(*this, i);
+            p->ops->flush(io, *p, false);
+            wrote = wrote || !p->dirty;
+        }
+    }
+    if (wrote) {
+        backend->flush();
+    }
+#endif
+    // 后端的周期性工作（分层存储的定时检查点等）
+    if (backend) {
+        backend->service();
+    }
+    return getDeferredMask() != 0;
+}
+
+// ============ 启用/禁用 EEPROM ============
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::enable()
+{
+    is_enabled = true;
+    FILE_DEBUG("[EEFILE] EEPROM enabled");
+}
+
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::disable()
+{
+    is_enabled = false;
+    FILE_DEBUG("[EEFILE] EEPROM disabled");
+}
+
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::isEnabled() const
+{
+    return is_enabled;
+}
+
+// ============ 自动注册文件 ============
+// 注意：实际占用空间 = maxSize + 1（第一个字节是有效性标记，位图模式下为 maxSize）
+//       EEFILE_ALIGN > 1 时标记独占一个单位，数据大小向上取整到单位
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::registerAuto(FileType type, uint16_t maxSize, uint8_t tier)
+{
+    // 检查是否已超过最大文件数
+    if (fileCount >= MAX_FILES) {
+        FILE_DEBUG("[EE] ERROR: Max files (%d) reached!", MAX_FILES);
+        stats.errors++;
+        return false;
+    }
+
+    // 检查类型是否在枚举范围内、是否已注册
+    if ((uint8_t)type >= MAX_FILES) {
+        FILE_DEBUG("[EE] ERROR: Type %d out of range (table holds %d)", (uint8_t)type, MAX_FILES);
+        stats.errors++;
+        return false;
+    }
+    if (findFileIndex(type) != NO_FILE) {
+        FILE_DEBUG("[EE] ERROR: Type %d already registered!", type);
+        stats.errors++;
+        return false;
+    }
+
+    // 检查总空间是否足够（需要 maxSize + 1 字节用于有效性标记）
+    uint16_t nextAddr = calculateNextAddr();
+    uint16_t actualSize = EEFILE_ALIGN_UP(maxSize) + EEFILE_MARKER_SIZE;  // +1 用于有效性标记
+    if (nextAddr + actualSize > DATA_SIZE) {
+        FILE_DEBUG("[EE] ERROR: Not enough space (need %d, available %d)",
+            actualSize, DATA_SIZE - nextAddr);
+        stats.errors++;
+        return false;
+    }
+
+    // 记录式后端按文件组织存储
+    if (!backend->mapRegion(fileCount, nextAddr, actualSize, tier)) {
+        FILE_DEBUG("[EE] ERROR: Backend cannot hold type %d (tier %d)", type, tier);
+        stats.errors++;
+        return false;
+    }
+
+    // 注册文件
+    files[fileCount].type = (uint8_t)type;
+    files[fileCount].maxSize = maxSize;  // 用户数据大小（不包括有效性标记）
+#if EEFILE_VERIFY
+    files[fileCount].startAddr = remapLookup(nextAddr);  // 坏区已搬到备用区时为新地址
+#else
+    files[fileCount].startAddr = nextAddr;  // 有效性标记所在地址
+#endif
+    files[fileCount].endAddr = nextAddr + actualSize - 1;  // 包含有效性标记
+    files[fileCount].dataLen = 0;
+    files[fileCount].enabled = true;
+    files[fileCount].modified = false;
+    files[fileCount].marker = EE_MARKER_UNKNOWN;
+#if EEFILE_POLICY
+    files[fileCount].policy = NULL;
+#endif
+#if EEFILE_WRITE_HASH
+    files[fileCount].hashKnown = false;
+#endif
+#if EEFILE_MONOTONIC_MARKER && !EEFILE_LAZY_MOUNT
+    // 上电检查撕裂写入（延迟挂载时推迟到首次访问或 service()）
+    markerState(fileCount);
+#endif
+#if EEFILE_SYNC
+    files[fileCount].sync.lo = files[fileCount].sync.sentLo = 0xFFFF;
+    files[fileCount].sync.hi = files[fileCount].sync.sentHi = 0;
+#endif
+
+    FILE_DEBUG("[EE] Type %d: 0x%04X-0x%04X (%d+%d bytes) [data: 0x%04X]",
+        type, nextAddr, nextAddr + actualSize - 1, maxSize, EEFILE_MARKER_SIZE,
+        nextAddr + EEFILE_MARKER_SIZE);
+
+    fileIndex[(uint8_t)type] = fileCount;
+    fileCount++;
+    return true;
+}
+
+#if EEFILE_POLICY
+// ============ 按策略注册文件 ============
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::registerPolicy(FileType type, EEPolicy& policy)
+{
+    if (policy.ops == NULL) {
+        return registerAuto(type, policy.size);
+    }
+    if (!registerAuto(type, policy.ops->footprint(policy))) {
+        return false;
+    }
+    policy.mounted = false;
+    files[fileCount - 1].policy = &policy;
+    FILE_DEBUG("[EE] Type %d: policy %d, %d data bytes", type, policy.ops->id, policy.size);
+#if !EEFILE_LAZY_MOUNT
+    policyOf(fileCount - 1);
+#endif
+    return true;
+}
+
+// 返回已挂载的策略，首次访问时从存储恢复策略状态
+template <class Backend, class Layout, class FileType>
+EEPolicy* EEFileT<Backend, Layout, FileType>::policyOf(uint8_t idx)
+{
+    EEPolicy* p = files[idx].policy;
+    if (p && !p->mounted) {
+        p->mounted = true;
+        p->hasData = false;
+        p->dirty = false;
+        EEPolicyPort<EEFileT> io(*this, idx);
+        p->ops->mount(io, *p);
+    }
+    return p;
+}
+
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::flush(void)
+{
+    for (uint8_t i = 0; i < fileCount; i++) {
+        EEPolicy* p = files[i].policy;
+        if (p && p->mounted && p->dirty && p->ops->flush) {
+            EEPolicyPort<EEFileT> io(*this, i);
+            p->ops->flush(io, *p, true);
+        }
+    }
+    backend->flush();
+}
+#endif
+
+// ============ 写入数据 ============
+// 存储格式：[有效性标记(0x01)] + [用户数据] + [填充0xFF]
+// commit=true 时数据写完才置有效标记（writeCommit）
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::doWrite(FileType type, const uint8_t* data, uint16_t length, bool commit)
+{
+    // 检查 EEPROM 是否启用
+    if (!is_enabled) {
+        FILE_DEBUG("[EE] ERROR: EEPROM disabled");
+        stats.errors++;
+        return false;
+    }
+
+    // 查找文件
+    uint8_t idx = findFileIndex(type);
+    if (idx == NO_FILE) {
+        FILE_DEBUG("[EE] ERROR: Type %d not found", type);
+        stats.errors++;
+        return false;
+    }
+
+    // 检查文件是否启用
+    if (!files[idx].enabled) {
+        FILE_DEBUG("[EE] ERROR: Type %d disabled", type);
+        stats.errors++;
+        return false;
+    }
+
+#if EEFILE_POLICY
+    // 按策略注册的文件由策略完成写入
+    EEPolicy* policy = policyOf(idx);
+    if (policy) {
+        EEPolicyPort<EEFileT> io(*this, idx);
+        if (length > policy->size || !policy->ops->write(io, *policy, data, length)) {
+            FILE_DEBUG("[EE] ERROR: Type %d policy %d write failed", type, policy->ops->id);
+            stats.errors++;
+            return false;
+        }
+        files[idx].dataLen = length;
+        files[idx].modified = true;
+        stats.writes++;
+        return true;
+    }
+#endif
+
+    // 检查数据长度
+    if (length > files[idx].maxSize) {
+        FILE_DEBUG("[EE] ERROR: Data %d > max %d", length, files[idx].maxSize);
+        stats.errors++;
+        return false;
+    }
+
+    uint16_t address = files[idx].startAddr;
+    uint16_t dataAddr = address + EEFILE_MARKER_SIZE;  // 数据从第二个字节开始
+
+#if EEFILE_WRITE_HASH
+    // 内容与器件上的有效内容相同：不编程，不改标记
+    uint32_t hash = contentHash(data, length, files[idx].maxSize);
+    if (sameContent(idx, data, length, hash)) {
+        files[idx].dataLen = length;
+        stats.writes++;
+        stats.hashSkips++;
+        FILE_DEBUG("[EE] Type %d: unchanged, write skipped", type);
+        return true;
+    }
+#endif
+
+#if EEFILE_VERIFY
+    verifyFailed = false;
+#endif
+
+    // ============ 关键设计：第一个字节是有效性标记 ============
+#if EEFILE_MONOTONIC_MARKER
+    // 单调标记：下一代写入中 -> 数据 -> 有效。由 updateBlock 在第一个变化的字节前切换标记，
+    // 内容未变则不编程，标记保持不动
+    markerArm = idx;
+    commit = true;
+#endif
+
+    // 1. 先写有效性标记（0x01 表示有效）
+    if (!commit) {
+        setMarker(idx, true);
+    }
+
+    // 2. 写入实际数据（从 address+1 开始），内容未变的字节不重复编程
+    // 3. 填充剩余空间为 0xFF
+    updateBlock(idx, dataAddr, data, length, files[idx].maxSize);
+#if EEFILE_MONOTONIC_MARKER
+    markerArm = NO_FILE;
+#endif
+
+    // 4. 提交：数据完整后才置有效标记（读回不一致时先搬到备用区重写，不提交坏数据）
+#if EEFILE_VERIFY
+    if (!verifyFailed && commit) {
+        setMarker(idx, true);
+    }
+    if (verifyFailed) {
+        return remapFile(idx) && doWrite(type, data, length, commit);
+    }
+#else
+    if (commit) {
+        setMarker(idx, true);
+    }
+#endif
+
+    // 更新元数据
+    files[idx].dataLen = length;
+    files[idx].modified = true;
+#if EEFILE_WRITE_HASH
+    files[idx].hash = hash;
+    files[idx].hashKnown = true;
+#endif
+    stats.writes++;
+
+    FILE_DEBUG("[EE] Type %d: wrote %d bytes (addr: 0x%04X, marker: 0x01)",
+        type, length, address);
+
+    return true;
+}
+
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::write(FileType type, const uint8_t* data, uint16_t length)
+{
+    EE_OP_BEGIN(EEP_OP_WRITE, type, length);
+    bool ok = doWrite(type, data, length, false);
+    ok = flushBackend() && ok;
+    EE_OP_END(EEP_OP_WRITE, type, length, ok);
+    return ok;
+}
+
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::writeCommit(FileType type, const uint8_t* data, uint16_t length)
+{
+    EE_OP_BEGIN(EEP_OP_WRITE, type, length);
+    bool ok = doWrite(type, data, length, true);
+    ok = flushBackend() && ok;
+    EE_OP_END(EEP_OP_WRITE, type, length, ok);
+    return ok;
+}
+
+// ============ 读取数据 ============
+// 读取格式：先检查有效性标记(address+0)，再读用户数据(address+1起)
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::doRead(FileType type, uint8_t* data, uint16_t length)
+{
+    // 检查 EEPROM 是否启用
+    if (!is_enabled) {
+        FILE_DEBUG("[EE] ERROR: EEPROM disabled");
+        stats.errors++;
+        return false;
+    }
+
+    // 查找文件
+    uint8_t idx = findFileIndex(type);
+    if (idx == NO_FILE) {
+        FILE_DEBUG("[EE] ERROR: Type %d not found", type);
+        stats.errors++;
+        return false;
+    }
+
+    // 检查文件是否启用
+    if (!files[idx].enabled) {
+        FILE_DEBUG("[EE] ERROR: Type %d disabled", type);
+        stats.errors++;
+        return false;
+    }
+
+#if EEFILE_POLICY
+    // 按策略注册的文件由策略完成读取
+    EEPolicy* policy = policyOf(idx);
+    if (policy) {
+        EEPolicyPort<EEFileT> io(*this, idx);
+        if (length > policy->size || !policy->ops->read(io, *policy, data, length)) {
+            FILE_DEBUG("[EE] ERROR: Type %d policy %d has no data", type, policy->ops->id);
+            stats.errors++;
+            return false;
+        }
+        stats.reads++;
+        return true;
+    }
+#endif
+
+    uint16_t address = files[idx].startAddr;
+    uint16_t dataAddr = address + EEFILE_MARKER_SIZE;  // 数据从第二个字节开始
+
+    // ============ 关键检查：读取有效性标记 ============
+    if (!markerValid(idx)) {
+        FILE_DEBUG("[EE] ERROR: Type %d data invalid", type);
+        stats.errors++;
+        return false;
+    }
+
+    // 检查数据长度
+    if (length != files[idx].dataLen) {
+        FILE_DEBUG("[EE] WARNING: Type %d expected %d, got %d",
+            type, files[idx].dataLen, length);
+    }
+
+    // 读取用户数据（从 address+1 开始）
+    // uint16_t readLen = (length < files[idx].dataLen) ? length : files[idx].dataLen;
+    uint16_t readLen = length;
+    uint16_t backendErrors = backend->getErrorCount();
+    ioReadBlock(dataAddr, data, readLen);
+    // 后端在读取中报错（I2C 无应答、镜像两份都损坏等）：数据不可信
+    if (backend->getErrorCount() != backendErrors) {
+        FILE_DEBUG("[EE] ERROR: Type %d backend read error", type);
+        stats.errors++;
+        return false;
+    }
+#if EEFILE_WRITE_HASH
+    // 完整读出时顺便重建哈希
+    if (readLen == files[idx].maxSize) {
+        files[idx].hash = contentHash(data, readLen, readLen);
+        files[idx].hashKnown = true;
+    }
+#endif
+
+    stats.reads++;
+
+    FILE_DEBUG("[EE] Type %d: read %d bytes", type, readLen);
+
+    return true;
+}
+
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::read(FileType type, uint8_t* data, uint16_t length)
+{
+    EE_OP_BEGIN(EEP_OP_READ, type, length);
+    bool ok = doRead(type, data, length);
+    EE_OP_END(EEP_OP_READ, type, length, ok);
+    return ok;
+}
+
+// ============ WOM 编码的小数值 ============
+// 文件数据区分成若干槽（每槽 EEW_SLOT_BYTES(bits) 字节），按顺序启用，
+// 最后一个已启用的槽保存当前值。返回当前槽下标（-1 表示没有）并读出其内容
+template <class Backend, class Layout, class FileType>
+int8_t EEFileT<Backend, Layout, FileType>::womCurrentSlot(uint8_t idx, uint8_t bits, uint8_t* slot)
+{
+    uint16_t dataAddr = files[idx].startAddr + EEFILE_MARKER_SIZE;
+    uint8_t slotBytes = EEW_SLOT_BYTES(bits);
+    uint16_t slots = files[idx].maxSize / slotBytes;
+
+    int8_t cur = -1;
+    uint8_t tmp[EEW_SLOT_BYTES(EEW_MAX_BITS)];
+    for (uint16_t s = 0; s < slots && s < 127; s++) {
+        ioReadBlock(dataAddr + s * slotBytes, tmp, slotBytes);
+        if (!eew_slot_used(tmp)) {
+            break;
+        }
+        memcpy(slot, tmp, slotBytes);
+        cur = (int8_t)s;
+    }
+    return cur;
+}
+
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::doWriteWom(FileType type, uint16_t value, uint8_t bits)
+{
+    if (!is_enabled) {
+        FILE_DEBUG("[EE] ERROR: EEPROM disabled");
+        stats.errors++;
+        return false;
+    }
+
+    uint8_t idx = findFileIndex(type);
+    if (idx == NO_FILE) {
+        FILE_DEBUG("[EE] ERROR: Type %d not found", type);
+        stats.errors++;
+        return false;
+    }
+
+    if (!files[idx].enabled) {
+        FILE_DEBUG("[EE] ERROR: Type %d disabled", type);
+        stats.errors++;
+        return false;
+    }
+
+    uint8_t slotBytes = EEW_SLOT_BYTES(bits);
+    uint16_t slots = files[idx].maxSize / slotBytes;
+    if (bits == 0 || bits > EEW_MAX_BITS || slots == 0) {
+        FILE_DEBUG("[EE] ERROR: Type %d too small for %d-bit WOM value", type, bits);
+        stats.errors++;
+        return false;
+    }
+    if (slots > 127) {
+        slots = 127;
+    }
+
+    uint16_t dataAddr = files[idx].startAddr + EEFILE_MARKER_SIZE;
+    uint8_t slot[EEW_SLOT_BYTES(EEW_MAX_BITS)];
+    int8_t cur = markerValid(idx) ? womCurrentSlot(idx, bits, slot) : -1;
+#if EEFILE_MONOTONIC_MARKER
+    // 与 doWrite 相同：第一个真正编程的字节之前标记进入“写入中”，槽写完再置有效
+    markerArm = idx;
+#endif
+
+    // 1. 当前槽还能只清零位写入：就地改写
+    // 2. 否则启用下一个槽（擦除态）
+    // 3. 槽全部用完（或文件尚无有效内容）：整块回到擦除态后从槽 0 开始
+    if (cur < 0 || !eew_encode_slot(slot, bits, value)) {
+        cur++;
+        if (cur == 0 || cur >= (int16_t)slots) {
+            updateBlock(idx, dataAddr, NULL, 0, slots * slotBytes);
+            cur = 0;
+            FILE_DEBUG("[EE] Type %d: WOM area erased", type);
+        }
+        memset(slot, 0xFF, slotBytes);
+        eew_encode_slot(slot, bits, value);
+    }
+
+    uint16_t slotAddr = dataAddr + cur * slotBytes;
+#if EEFILE_VERIFY
+    verifyFailed = false;
+#endif
+    updateBlock(idx, slotAddr, slot, slotBytes, slotBytes);
+#if EEFILE_MONOTONIC_MARKER
+    markerArm = NO_FILE;
+#endif
+    setMarker(idx, true);
+#if EEFILE_VERIFY
+    if (verifyFailed) {
+        return remapFile(idx) && doWriteWom(type, value, bits);
+    }
+#endif
+
+    files[idx].dataLen = slots * slotBytes;
+    files[idx].modified = true;
+#if EEFILE_WRITE_HASH
+    files[idx].hashKnown = false;
+#endif
+    stats.writes++;
+
+    FILE_DEBUG("[EE] Type %d: WOM value %u (slot %d/%d)", type, value, cur, slots);
+    return true;
+}
+
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::writeWom(FileType type, uint16_t value, uint8_t bits)
+{
+    EE_OP_BEGIN(EEP_OP_WRITE, type, EEW_SLOT_BYTES(bits));
+    bool ok = doWriteWom(type, value, bits);
+    ok = flushBackend() && ok;
+    EE_OP_END(EEP_OP_WRITE, type, EEW_SLOT_BYTES(bits), ok);
+    return ok;
+}
+
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::readWom(FileType type, uint16_t* value, uint8_t bits)
+{
+    EE_OP_BEGIN(EEP_OP_READ, type, EEW_SLOT_BYTES(bits));
+    uint8_t idx = findFileIndex(type);
+    bool ok = (idx != NO_FILE) && is_enabled && files[idx].enabled &&
+              bits > 0 && bits <= EEW_MAX_BITS && markerValid(idx);
+
+    uint8_t slot[EEW_SLOT_BYTES(EEW_MAX_BITS)];
+    if (ok && womCurrentSlot(idx, bits, slot) >= 0) {
+        *value = eew_decode_slot(slot, bits);
+        stats.reads++;
+    } else {
+        FILE_DEBUG("[EE] ERROR: Type %d has no WOM value", type);
+        stats.errors++;
+        ok = false;
+    }
+    EE_OP_END(EEP_OP_READ, type, EEW_SLOT_BYTES(bits), ok);
+    return ok;
+}
+
+// ============ 部分读写 ============
+// 返回文件下标，EEPROM 禁用、文件不存在/禁用或范围越界时返回 NO_FILE
+template <class Backend, class Layout, class FileType>
+uint8_t EEFileT<Backend, Layout, FileType>::rangeIndex(FileType type, uint16_t offset, uint16_t length)
+{
+    uint8_t idx = findFileIndex(type);
+    if (!is_enabled || idx == NO_FILE || !files[idx].enabled ||
+        offset > files[idx].maxSize || length > files[idx].maxSize - offset) {
+        FILE_DEBUG("[EE] ERROR: Type %d range %d+%d invalid", type, offset, length);
+        stats.errors++;
+        return NO_FILE;
+    }
+    return idx;
+}
+
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::readAt(FileType type, uint16_t offset, uint8_t* data, uint16_t length)
+{
+    EE_OP_BEGIN(EEP_OP_READ, type, length);
+    uint8_t idx = rangeIndex(type, offset, length);
+    if (idx != NO_FILE) {
+        ioReadBlock(files[idx].startAddr + EEFILE_MARKER_SIZE + offset, data, length);
+        stats.reads++;
+    }
+    EE_OP_END(EEP_OP_READ, type, length, idx != NO_FILE);
+    return idx != NO_FILE;
+}
+
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::writeAt(FileType type, uint16_t offset, const uint8_t* data, uint16_t length,
+    bool commit)
+{
+    EE_OP_BEGIN(EEP_OP_WRITE, type, length);
+    uint8_t idx = rangeIndex(type, offset, length);
+    bool ok = (idx != NO_FILE);
+    if (ok) {
+#if EEFILE_VERIFY
+        verifyFailed = false;
+#endif
+        updateBlock(idx, files[idx].startAddr + EEFILE_MARKER_SIZE + offset, data, length, length);
+#if EEFILE_VERIFY
+        // 读回不一致：搬到备用区后在新位置重写
+        while (ok && verifyFailed) {
+            ok = remapFile(idx);
+            if (ok) {
+                updateBlock(idx, files[idx].startAddr + EEFILE_MARKER_SIZE + offset, data, length, length);
+            }
+        }
+#endif
+    }
+    if (ok) {
+        files[idx].modified = true;
+#if EEFILE_WRITE_HASH
+        files[idx].hashKnown = false;
+#endif
+        stats.writes++;
+    }
+    if (commit) {
+        ok = flushBackend() && ok;
+    }
+    EE_OP_END(EEP_OP_WRITE, type, length, ok);
+    return ok;
+}
+
+// ============ 清除文件 ============
+// 只需将有效性标记设置为 0x00，数据部分不必清除
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::doErase(FileType type)
+{
+    // 检查 EEPROM 是否启用
+    if (!is_enabled) {
+        FILE_DEBUG("[EE] ERROR: EEPROM disabled");
+        stats.errors++;
+        return false;
+    }
+
+    // 查找文件
+    uint8_t idx = findFileIndex(type);
+    if (idx == NO_FILE) {
+        FILE_DEBUG("[EE] ERROR: Type %d not found", type);
+        stats.errors++;
+        return false;
+    }
+
+    // 只需将有效性标记设置为 0x00（表示无效）
+    // 这样下次读取时会检查到标记无效，而不需要清除所有数据
+    setMarker(idx, false);
+#if EEFILE_POLICY
+    // 策略的缓存内容一并丢弃
+    if (policyOf(idx)) {
+        files[idx].policy->hasData = false;
+        files[idx].policy->dirty = false;
+    }
+#endif
+
+    // 重置元数据
+    files[idx].dataLen = 0;
+    files[idx].modified = false;
+    stats.erases++;
+
+    FILE_DEBUG("[EE] Type %d erased (marker: 0x00)", type);
+
+    return true;
+}
+
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::erase(FileType type)
+{
+    EE_OP_BEGIN(EEP_OP_ERASE, type, 0);
+    bool ok = doErase(type);
+    ok = flushBackend() && ok;
+    EE_OP_END(EEP_OP_ERASE, type, 0, ok);
+    return ok;
+}
+
+// ============ 启用/禁用文件 ============
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::setFileEnabled(FileType type, bool enabled)
+{
+    uint8_t idx = findFileIndex(type);
+    if (idx != NO_FILE) {
+        files[idx].enabled = enabled;
+        FILE_DEBUG("[EE] Type %d: %s", type, enabled ? "enabled" : "disabled");
+    }
+}
+
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::isFileEnabled(FileType type)
+{
+    uint8_t idx = findFileIndex(type);
+    return (idx != NO_FILE) ? files[idx].enabled : false;
+}
+
+// ============ 获取文件数据长度 ============
+template <class Backend, class Layout, class FileType>
+uint16_t EEFileT<Backend, Layout, FileType>::getFileDataLen(FileType type)
+{
+    uint8_t idx = findFileIndex(type);
+    return (idx != NO_FILE) ? files[idx].dataLen : 0;
+}
+
+// ============ 获取文件最大数据大小 ============
+template <class Backend, class Layout, class FileType>
+uint16_t EEFileT<Backend, Layout, FileType>::getFileMaxSize(FileType type)
+{
+    uint8_t idx = findFileIndex(type);
+    return (idx != NO_FILE) ? files[idx].maxSize : 0;
+}
+
+// ============ 获取文件是否被修改 ============
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::isFileModified(FileType type)
+{
+    uint8_t idx = findFileIndex(type);
+    return (idx != NO_FILE) ? files[idx].modified : false;
+}
+
+// ============ 清除修改标志 ============
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::clearModifiedFlag(FileType type)
+{
+    uint8_t idx = findFileIndex(type);
+    if (idx != NO_FILE) {
+        files[idx].modified = false;
+        FILE_DEBUG("[EE] Type %d: modified flag cleared", type);
+    }
+}
+
+// ============ 检查文件有效性（首次从 Flash 读取标记，之后用缓存）============
+template <class Backend, class Layout, class FileType>
+bool EEFileT<Backend, Layout, FileType>::isFileValid(FileType type)
+{
+    EE_OP_BEGIN(EEP_OP_IS_VALID, type, 0);
+    uint8_t idx = findFileIndex(type);
+    if (idx == NO_FILE) {
+        EE_OP_END(EEP_OP_IS_VALID, type, 0, false);
+        return false;
+    }
+
+    bool isValid = markerValid(idx);
+
+    FILE_DEBUG("[EE] Type %d: isValid=%s", type, isValid ? "true" : "false");
+    EE_OP_END(EEP_OP_IS_VALID, type, 0, true);
+
+    return isValid;
+}
+
+// ============ 设置文件有效性标记（写入 Flash）============
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::setFileValid(FileType type, bool valid)
+{
+    uint8_t op = valid ? EEP_OP_SET_VALID : EEP_OP_SET_INVALID;
+    (void)op;                                  // 钩子与轨迹都关闭时未使用
+    EE_OP_BEGIN(op, type, 0);
+    uint8_t idx = findFileIndex(type);
+    if (idx == NO_FILE) {
+        FILE_DEBUG("[EE] ERROR: Type %d not found", type);
+        stats.errors++;
+        EE_OP_END(op, type, 0, false);
+        return;
+    }
+
+    setMarker(idx, valid);
+    backend->flush();
+
+    FILE_DEBUG("[EE] Type %d: setValid=%s", type, valid ? "true" : "false");
+    EE_OP_END(op, type, 0, true);
+}
+
+// ============ 批量设置有效性标记 ============
+// 位图模式下先改内存中的位，最后只提交一次槽，多个文件同时生效
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::setFilesValid(const FileType* types, uint8_t count, bool valid)
+{
+    bool changed = false;
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t idx = findFileIndex(types[i]);
+        if (idx == NO_FILE) {
+            FILE_DEBUG("[EE] ERROR: Type %d not found", types[i]);
+            stats.errors++;
+            continue;
+        }
+#if EEFILE_VALID_BITMAP
+        changed = vbmSetBit(idx, valid) || changed;
+#else
+        setMarker(idx, valid);
+#endif
+    }
+#if EEFILE_VALID_BITMAP
+    if (changed) {
+        vbmCommit();
+    }
+#endif
+    (void)changed;
+    backend->flush();
+
+    FILE_DEBUG("[EE] %d files: setValid=%s", count, valid ? "true" : "false");
+}
+
+// ============ 获取标记状态 ============
+template <class Backend, class Layout, class FileType>
+uint8_t EEFileT<Backend, Layout, FileType>::getMarkerState(FileType type)
+{
+    uint8_t idx = findFileIndex(type);
+    if (idx == NO_FILE) {
+        return EE_MARKER_UNKNOWN;
+    }
+#if EEFILE_VALID_BITMAP
+    return markerValid(idx) ? EE_MARKER_VALID : EE_MARKER_INVALID;
+#else
+    return markerState(idx);
+#endif
+}
+
+// ============ 获取文件地址（调试用）============
+template <class Backend, class Layout, class FileType>
+uint16_t EEFileT<Backend, Layout, FileType>::getFileAddr(FileType type)
+{
+    uint8_t idx = findFileIndex(type);
+    return (idx != NO_FILE) ? files[idx].startAddr : 0;
+}
+
+// ============ 打印全局状态 ============
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::printStatus()
+{
+    FILE_DEBUG("\n====== EEFILE Status ======");
+    FILE_DEBUG("Enabled: %s", is_enabled ? "Yes" : "No");
+    FILE_DEBUG("Total: %d bytes (%d sectors)", TOTAL_SIZE, Layout::NUM_SECTORS);
+    FILE_DEBUG("Registered: %d files", fileCount);
+    FILE_DEBUG("Deferred: 0x%08lX", (unsigned long)getDeferredMask());
+    FILE_DEBUG("Marker writes: %lu (skipped %lu)\n",
+        (unsigned long)stats.markerWrites, (unsigned long)stats.markerSkips);
+#if EEFILE_WRITE_HASH
+    FILE_DEBUG("Unchanged writes skipped: %lu\n", (unsigned long)stats.hashSkips);
+#endif
+
+    for (uint8_t i = 0; i < fileCount; i++) {
+        FILE_DEBUG("  Type %d: 0x%04X-%04X (%d bytes) [%s|%s|V%d]",
+            files[i].type,
+            files[i].startAddr,
+            files[i].endAddr,
+            files[i].dataLen,
+            files[i].enabled ? "E" : "D",
+            files[i].modified ? "M" : "C",
+            markerValid(i));
+    }
+
+    FILE_DEBUG("===========================\n");
+}
+
+// ============ 打印单个文件信息 ============
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::printFileInfo(FileType type)
+{
+    uint8_t idx = findFileIndex(type);
+    if (idx == NO_FILE) {
+        FILE_DEBUG("[EE] Type %d not found", type);
+        return;
+    }
+
+    FILE_DEBUG("\n---- Type %d Info ----", type);
+    FILE_DEBUG("Address: 0x%04X", files[idx].startAddr);
+    FILE_DEBUG("Max size: %d bytes", files[idx].maxSize);
+    FILE_DEBUG("Data len: %d bytes", files[idx].dataLen);
+    FILE_DEBUG("Enabled: %s", files[idx].enabled ? "Yes" : "No");
+    FILE_DEBUG("Modified: %s", files[idx].modified ? "Yes" : "No");
+    FILE_DEBUG("--------------------\n");
+}
+
+// ============ 获取/清零运行计数 ============
+template <class Backend, class Layout, class FileType>
+const EEStats &EEFileT<Backend, Layout, FileType>::getStats() const
+{
+    return stats;
+}
+
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::resetStats()
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+// ============ 二进制状态导出 ============
+// 格式见 eefile_proto.h，缓冲区不足时返回 0
+// 状态头和有效位图，返回字节数
+template <class Backend, class Layout, class FileType>
+uint16_t EEFileT<Backend, Layout, FileType>::statusHead(uint8_t* buf)
+{
+    uint16_t used = (fileCount > 0) ? files[fileCount - 1].endAddr + 1 : 0;
+    eep_put_u16(buf + 0, EEP_STATUS_MAGIC);
+    buf[2] = EEP_STATUS_VERSION;
+    buf[3] = is_enabled ? EEP_STATUS_ENABLED : 0;
+    buf[4] = fileCount;
+    buf[5] = MAX_FILES;
+    eep_put_u16(buf + 6, TOTAL_SIZE);
+    eep_put_u16(buf + 8, used);
+    eep_put_u32(buf + 10, stats.reads);
+    eep_put_u32(buf + 14, stats.writes);
+    eep_put_u32(buf + 18, stats.erases);
+    eep_put_u32(buf + 22, stats.bytesProgrammed);
+    eep_put_u16(buf + 26, stats.errors);
+    eep_put_u32(buf + 28, stats.markerWrites);
+    eep_put_u32(buf + 32, stats.markerSkips);
+    eep_put_u32(buf + 36, stats.hashSkips);
+    eep_put_u16(buf + 40, stats.verifyFailures);
+    eep_put_u16(buf + 42, stats.remaps);
+
+    uint8_t* bitmap = buf + EEP_STATUS_HEADER_SIZE;
+    memset(bitmap, 0, EEP_STATUS_BITMAP_SIZE(fileCount));
+    for (uint8_t i = 0; i < fileCount; i++) {
+        if (markerValid(i)) {
+            bitmap[i >> 3] |= (uint8_t)(1 << (i & 7));
+        }
+    }
+    return EEP_STATUS_HEADER_SIZE + EEP_STATUS_BITMAP_SIZE(fileCount);
+}
+
+// 第 i 个文件的记录，有效位取自 statusHead() 写出的位图
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::statusRecord(uint8_t i, const uint8_t* bitmap, uint8_t* rec)
+{
+    bool valid = (bitmap[i >> 3] >> (i & 7)) & 1;
+    rec[0] = (uint8_t)files[i].type;
+    rec[1] = (files[i].enabled ? EEP_STATUS_ENABLED : 0) |
+             (files[i].modified ? EEP_STATUS_MODIFIED : 0) |
+             (valid ? EEP_STATUS_VALID : 0);
+    eep_put_u16(rec + 2, files[i].startAddr);
+    eep_put_u16(rec + 4, files[i].maxSize);
+    eep_put_u16(rec + 6, files[i].dataLen);
+}
+
+template <class Backend, class Layout, class FileType>
+uint16_t EEFileT<Backend, Layout, FileType>::exportStatus(uint8_t* buf, uint16_t size)
+{
+    uint16_t total = EEP_STATUS_SIZE(fileCount);
+    if (size < total) {
+        return 0;
+    }
+
+    uint16_t head = statusHead(buf);
+    for (uint8_t i = 0; i < fileCount; i++) {
+        statusRecord(i, buf + EEP_STATUS_HEADER_SIZE, buf + head + i * EEP_STATUS_FILE_SIZE);
+    }
+    return total;
+}
+
+// ============ 以协议帧形式输出状态（无格式化开销）============
+// 帧头、状态头和位图一次写出，文件记录逐条写出并累计 CRC，栈上只有一条记录
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::printStatusBinary(Print &out)
+{
+    uint8_t head[EEP_HEADER_SIZE + EEP_STATUS_HEADER_SIZE + EEP_STATUS_BITMAP_SIZE(MAX_FILES)];
+    uint8_t rec[EEP_STATUS_FILE_SIZE];
+    uint16_t n = EEP_HEADER_SIZE + statusHead(head + EEP_HEADER_SIZE);
+
+    head[0] = EEP_SOF;
+    head[1] = EEP_CMD_STATUS;
+    eep_put_u16(head + 2, EEP_STATUS_SIZE(fileCount));
+    uint16_t crc = 0xFFFF;
+    for (uint16_t i = 1; i < n; i++) {
+        crc = eep_crc16_update(crc, head[i]);
+    }
+    out.write(head, n);
+
+    for (uint8_t i = 0; i < fileCount; i++) {
+        statusRecord(i, head + EEP_HEADER_SIZE + EEP_STATUS_HEADER_SIZE, rec);
+        for (uint8_t k = 0; k < sizeof(rec); k++) {
+            crc = eep_crc16_update(crc, rec[k]);
+        }
+        out.write(rec, sizeof(rec));
+    }
+    eep_put_u16(rec, crc);
+    out.write(rec, 2);
+}
+
+#if EEFILE_TRACE || EEFILE_WCET
+// ============ 公共操作结束：记录轨迹、更新最坏执行时间 ============
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::opDone(uint8_t op, FileType type, uint16_t length, bool ok, uint32_t cycles)
+{
+#if EEFILE_TRACE
+    traceOp(op, type, length, ok);
+#endif
+#if EEFILE_WCET
+    if (cycles > wcetMax[op]) {
+        wcetMax[op] = cycles;
+    }
+    if (wcetBound[op] != 0 && cycles > wcetBound[op]) {
+        wcetOverruns++;
+        EEFILE_WCET_OVERRUN(op, cycles);
+    }
+#endif
+    (void)type;
+    (void)length;
+    (void)ok;
+    (void)cycles;
+}
+#endif
+
+#if EEFILE_WCET
+// ============ 最坏执行时间查询 ============
+template <class Backend, class Layout, class FileType>
+uint32_t EEFileT<Backend, Layout, FileType>::getWorstCycles(uint8_t op) const
+{
+    return (op < EEP_OP_COUNT) ? wcetMax[op] : 0;
+}
+
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::setCycleBound(uint8_t op, uint32_t cycles)
+{
+    if (op < EEP_OP_COUNT) {
+        wcetBound[op] = cycles;
+    }
+}
+
+template <class Backend, class Layout, class FileType>
+uint16_t EEFileT<Backend, Layout, FileType>::getWcetOverruns() const
+{
+    return wcetOverruns;
+}
+
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::resetWcet()
+{
+    memset(wcetMax, 0, sizeof(wcetMax));
+    wcetOverruns = 0;
+}
+
+// ============ 以协议帧输出最坏执行时间 ============
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::printWcetBinary(Print &out)
+{
+    uint8_t frame[EEP_HEADER_SIZE + EEP_WCET_SIZE + 2];
+    uint8_t* p = frame + EEP_HEADER_SIZE;
+    eep_put_u16(p, wcetOverruns);
+    for (uint8_t op = 0; op < EEP_OP_COUNT; op++) {
+        eep_put_u32(p + 2 + op * 4, wcetMax[op]);
+    }
+    out.write(frame, eep_seal_frame(frame, EEP_CMD_WCET, EEP_WCET_SIZE));
+}
+#endif
+
+#if EEFILE_TRACE
+// ============ 记录一条操作轨迹 ============
+// 缓冲满时覆盖最旧的记录，并累计丢弃数，主机据此判断轨迹是否连续
+template <class Backend, class Layout, class FileType>
+void EEFileT<Backend, Layout, FileType>::traceOp(uint8_t op, FileType type, uint16_t length, bool ok)
+{
+    uint32_t now = millis();
+    uint32_t dt = now - traceLastMs;
+    traceLastMs = now;
+
+    uint8_t slot;
+    if (traceCount < EEFILE_TRACE_DEPTH) {
+        slot = (traceHead + traceCount) % EEFILE_TRACE_DEPTH;
+        traceCount++;
+    } else {
+        slot = traceHead;
+        traceHead = (traceHead + 1) % EEFILE_TRACE_DEPTH;
+        traceDropped++;
+    }
+
+    trace[slot].dt = (dt > 0xFFFF) ? 0xFFFF : (uint16_t)dt;
+    trace[slot].op = ok ? op : (op | EEP_OP_FAILED);
+    trace[slot].type = (uint8_t)type;
+    trace[slot].len = length;
+}
+
+// ============ 取出轨迹并以协议帧输出 ============
+template <class Backend, class Layout, class FileType>
+uint16_t EEFileT<Backend, Layout, FileType>::printTraceBinary(Print &out)
+{
+    uint16_t total = 0;
+    do {
+        uint8_t frame[EEP_HEADER_SIZE + 2 + EEP_TRACE_PER_FRAME * EEP_TRACE_RECORD_SIZE + 2];
+        uint8_t* p = frame + EEP_HEADER_SIZE;
+        uint8_t n = 0;
+
+        eep_put_u16(p, traceDropped);
+        p += 2;
+        traceDropped = 0;
+
+        while (traceCount > 0 && n < EEP_TRACE_PER_FRAME) {
+            const EETraceRecord &r = trace[traceHead];
+            eep_put_u16(p, r.dt);
+            p[2] = r.op;
+            p[3] = r.type;
+            eep_put_u16(p + 4, r.len);
+            p += EEP_TRACE_RECORD_SIZE;
+            traceHead = (traceHead + 1) % EEFILE_TRACE_DEPTH;
+            traceCount--;
+            n++;
+        }
+
+        out.write(frame, eep_seal_frame(frame, EEP_CMD_TRACE, 2 + n * EEP_TRACE_RECORD_SIZE));
+        total += n;
+    } while (traceCount > 0);
+
+    return total;
+}
+#endif
+
+#endif
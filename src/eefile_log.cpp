@@ -0,0 +1,259 @@
+/**
+ * @file eefile_log.cpp
+ * @brief 环形日志文件类型实现
+ */
+
+#include "eefile_log.h"
+
+EELog::EELog(EEFileType type, uint16_t recSize, EEFILE& fs)
+    : fs(fs), type(type), recSize(recSize), extra(0), slots(0), next(0), used(0),
+      seqNext(0), probes(0), mounted(true)
+{
+}
+
+EELog::EELog(EEFileType type, uint16_t recSize, uint8_t extra, EEFILE& fs)
+    : fs(fs), type(type), recSize(recSize), extra(extra > 4 ? 4 : extra),
+      slots(0), next(0), used(0), seqNext(0), probes(0), mounted(true)
+{
+}
+
+uint16_t EELog::slotSize(void) const
+{
+    return recSize + EELOG_OVERHEAD + extra;
+}
+
+// 顺序号所在的槽：最新记录在 next 之前一个槽
+uint16_t EELog::slotOf(uint32_t seq) const
+{
+    return (next + slots - 1 - (seqNext - 1 - seq) % slots) % slots;
+}
+
+// ============ 读一个槽：CRC 不符（空白或撕裂）返回 false ============
+bool EELog::readSlot(uint16_t slot, uint32_t* seq, void* rec)
+{
+    uint8_t head[4];
+    uint8_t chunk[16];
+    uint16_t base = slot * slotSize();
+    uint16_t crc = 0xFFFF;
+
+    if (!fs.readAt(type, base, head, sizeof(head))) {
+        return false;
+    }
+    for (uint8_t i = 0; i < sizeof(head); i++) {
+        crc = eep_crc16_update(crc, head[i]);
+    }
+    // 数据分段读出校验；rec 非空时顺便复制
+    for (uint16_t off = 0; off < recSize; off += sizeof(chunk)) {
+        uint16_t n = recSize - off;
+        if (n > sizeof(chunk)) {
+            n = sizeof(chunk);
+        }
+        fs.readAt(type, base + 4 + off, chunk, n);
+        for (uint16_t i = 0; i < n; i++) {
+            crc = eep_crc16_update(crc, chunk[i]);
+        }
+        if (rec) {
+            memcpy((uint8_t*)rec + off, chunk, n);
+        }
+    }
+    uint8_t tail[2];
+    fs.readAt(type, base + 4 + recSize, tail, sizeof(tail));
+    *seq = eep_get_u32(head);
+    return eep_get_u16(tail) == crc;
+}
+
+// ============ 挂载 ============
+bool EELog::begin(void)
+{
+    slots = fs.getFileMaxSize(type) / slotSize();
+    next = 0;
+    used = 0;
+    seqNext = 0;
+    probes = 0;
+    mounted = true;
+    if (slots == 0) {
+        FILE_DEBUG("[EELOG] ERROR: Type %d cannot hold a record", type);
+        return false;
+    }
+    mounted = false;
+#if !EEFILE_LAZY_MOUNT
+    mount();
+#endif
+    return true;
+}
+
+void EELog::mount(void)
+{
+    if (!mounted) {
+        mounted = true;
+        doMount();
+    }
+}
+
+bool EELog::isMounted(void) const
+{
+    return mounted;
+}
+
+// 查询接口也可能是首次访问
+void EELog::ensureMounted(void) const
+{
+    if (!mounted) {
+        const_cast<EELog*>(this)->mount();
+    }
+}
+
+// ============ 二分查找本圈与上一圈的分界 ============
+void EELog::doMount(void)
+{
+    uint32_t seq0;
+    uint32_t seq;
+    probes++;
+    if (!readSlot(0, &seq0, NULL)) {
+        // 槽 0 为空：日志为空，或整圈写满后槽 0 正好被撕裂
+        probes++;
+        if (slots > 1 && readSlot(slots - 1, &seq, NULL)) {
+            used = slots - 1;
+            seqNext = seq + 1;
+        }
+        FILE_DEBUG("[EELOG] Type %d: %d records, next slot 0", type, used);
+        return;
+    }
+
+    // 槽 [0, lo) 属于本圈（有效且顺序号不小于槽 0），之后不是
+    uint16_t lo = 1;
+    uint16_t hi = slots;
+    while (lo < hi) {
+        uint16_t mid = lo + (hi - lo) / 2;
+        probes++;
+        if (readSlot(mid, &seq, NULL) && seq - seq0 == mid) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    seqNext = seq0 + lo;
+    next = lo % slots;
+    used = lo;
+
+    // 分界之后若还有上一圈的记录，说明日志已写满过
+    if (lo < slots) {
+        probes++;
+        if (readSlot(slots - 1, &seq, NULL) && seq == seq0 - 1) {
+            probes++;
+            used = readSlot(lo, &seq, NULL) ? slots : slots - 1;
+        }
+    }
+    FILE_DEBUG("[EELOG] Type %d: %d records, next slot %d (%d probes)", type, used, next, probes);
+}
+
+// ============ 追加：顺序号、数据、CRC 一次写入，CRC 在最后 ============
+bool EELog::append(const void* rec)
+{
+    ensureMounted();
+    if (slots == 0) {
+        return false;
+    }
+    uint8_t head[4];
+    uint8_t tail[2];
+    uint16_t crc = 0xFFFF;
+    uint16_t base = next * slotSize();
+
+    eep_put_u32(head, seqNext);
+    for (uint8_t i = 0; i < sizeof(head); i++) {
+        crc = eep_crc16_update(crc, head[i]);
+    }
+    for (uint16_t i = 0; i < recSize; i++) {
+        crc = eep_crc16_update(crc, ((const uint8_t*)rec)[i]);
+    }
+    eep_put_u16(tail, crc);
+
+    // 槽内先写顺序号、数据和附加字节，最后写 CRC：中途掉电只会留下一条 CRC 不符的记录
+    uint8_t blank[4] = {0xFF, 0xFF, 0xFF, 0xFF};
+    if (!fs.writeAt(type, base, head, sizeof(head), false) ||
+        !fs.writeAt(type, base + 4, (const uint8_t*)rec, recSize, false) ||
+        (extra && !fs.writeAt(type, base + EELOG_OVERHEAD + recSize, blank, extra, false)) ||
+        !fs.writeAt(type, base + 4 + recSize, tail, sizeof(tail))) {
+        return false;
+    }
+
+    seqNext++;
+    next = (next + 1) % slots;
+    if (used < slots) {
+        used++;
+    }
+    return true;
+}
+
+// ============ 读取 ============
+bool EELog::readOldest(uint16_t n, void* rec, uint32_t* seq)
+{
+    ensureMounted();
+    if (n >= used) {
+        return false;
+    }
+    uint32_t s = seqNext - used + n;
+    if (seq) {
+        *seq = s;
+    }
+    return readSeq(s, rec);
+}
+
+bool EELog::readNewest(uint16_t back, void* rec, uint32_t* seq)
+{
+    ensureMounted();
+    if (back >= used) {
+        return false;
+    }
+    return readOldest(used - 1 - back, rec, seq);
+}
+
+bool EELog::readSeq(uint32_t seq, void* rec)
+{
+    ensureMounted();
+    if (seq >= seqNext || seqNext - 1 - seq >= used) {
+        return false;
+    }
+    uint32_t stored;
+    return readSlot(slotOf(seq), &stored, rec) && stored == seq;
+}
+
+void EELog::clear(void)
+{
+    uint8_t blank[4] = {0xFF, 0xFF, 0xFF, 0xFF};
+    for (uint16_t i = 0; i < slots; i++) {
+        fs.writeAt(type, i * slotSize(), blank, sizeof(blank));
+    }
+    next = 0;
+    used = 0;
+    seqNext = 0;
+    mounted = true;
+}
+
+uint16_t EELog::count(void) const
+{
+    ensureMounted();
+    return used;
+}
+
+uint16_t EELog::capacity(void) const
+{
+    return slots;
+}
+
+uint32_t EELog::newestSeq(void) const
+{
+    ensureMounted();
+    return seqNext - 1;
+}
+
+uint32_t EELog::oldestSeq(void) const
+{
+    ensureMounted();
+    return seqNext - used;
+}
+
+uint8_t EELog::getMountProbes(void) const
+{
+    return probes;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file eefile_log.h
+ * @brief 环形日志文件类型：定长记录、顺序号、挂载时二分查找写入位置
+ *
+ * 一个 EEFILE 文件分成若干槽，每槽一条记录：
+ *   [顺序号 u32][用户数据 recSize 字节][CRC16]
+ * 记录按槽顺序循环写入，顺序号逐条加 1，CRC 覆盖顺序号与数据、最后写入。
+ * 因此槽 0 之后“本圈”的记录顺序号连续递增，其后是上一圈（更小）或空白的槽，
+ * begin() 只需对这一分界做二分查找（O(log n) 次读取），不必扫描整个日志。
+ * 写到一半掉电的记录 CRC 不符，按空槽处理，只丢失这一条。
+ * EEFILE_LAZY_MOUNT=1 时 begin() 不读取存储，查找推迟到首次访问或 mount()。
+ *
+ * 用法：
+ *   EE_REG(SAMPLES, EELOG_SIZE(sizeof(Sample), 64));
+ *   EELog samples(SAMPLES, sizeof(Sample));
+ *   samples.begin();
+ *   samples.append(&s);
+ *   for (uint16_t i = 0; i < samples.count(); i++) samples.readNewest(i, &s);
+ */
+
+#ifndef __EEFILE_LOG__
+#define __EEFILE_LOG__
+
+#include "eefile.h"
+
+#define EELOG_OVERHEAD 6                            // 顺序号 4 字节 + CRC 2 字节
+
+// 日志文件注册大小：recSize 字节的记录 count 条
+#define EELOG_SIZE(recSize, count) ((uint16_t)(((recSize) + EELOG_OVERHEAD) * (count)))
+
+class EELog
+{
+  public:
+    /**
+     * @param type 已注册的文件类型，大小用 EELOG_SIZE()
+     * @param recSize 每条记录的用户数据字节数
+     */
+    EELog(EEFileType type, uint16_t recSize, EEFILE& fs = EEFILE::getInstance());
+
+    /**
+     * @brief 挂载：二分查找最新记录，须在文件注册之后调用
+     * @return 文件存在且至少能放下一条记录
+     */
+    bool begin(void);
+
+    /**
+     * @brief 完成推迟的挂载（EEFILE_LAZY_MOUNT=1 时可在空闲时调用），已挂载时不做任何事
+     */
+    void mount(void);
+    bool isMounted(void) const;
+
+    /**
+     * @brief 追加一条记录，日志满时覆盖最旧的记录
+     */
+    bool append(const void* rec);
+
+    /**
+     * @brief 读取从最新往回数第 back 条记录（0 为最新）
+     * @param seq 可选，返回该记录的顺序号
+     */
+    bool readNewest(uint16_t back, void* rec, uint32_t* seq = NULL);
+
+    /**
+     * @brief 读取从最旧往后数第 n 条记录（0 为最旧）
+     */
+    bool readOldest(uint16_t n, void* rec, uint32_t* seq = NULL);
+
+    /**
+     * @brief 按顺序号读取（记录已被覆盖时返回 false）
+     */
+    bool readSeq(uint32_t seq, void* rec);
+
+    /**
+     * @brief 清空日志（每个槽的顺序号写为空白）
+     */
+    void clear(void);
+
+    uint16_t count(void) const;         // 当前记录条数
+    uint16_t capacity(void) const;      // 最多记录条数
+    uint32_t newestSeq(void) const;     // 最新记录的顺序号（count() 为 0 时无意义）
+    uint32_t oldestSeq(void) const;     // 最旧记录的顺序号
+    uint8_t getMountProbes(void) const; // begin() 读取的记录数
+
+  protected:
+    /**
+     * @param extra 每槽 CRC 之后附加的字节数（不受 CRC 保护，追加时写为 0xFF，最多 4）
+     */
+    EELog(EEFileType type, uint16_t recSize, uint8_t extra, EEFILE& fs);
+
+    EEFILE& fs;
+    EEFileType type;
+    uint16_t recSize;
+    uint8_t extra;
+    uint16_t slots;
+    uint16_t next;                      // 下一条记录写入的槽
+    uint16_t used;
+    uint32_t seqNext;                   // 下一条记录的顺序号
+    uint8_t probes;
+    bool mounted;
+
+    virtual void doMount(void);         // 查找写入位置，派生类在此重建自身状态
+    void ensureMounted(void) const;
+    uint16_t slotSize(void) const;
+    uint16_t slotOf(uint32_t seq) const;
+    bool readSlot(uint16_t slot, uint32_t* seq, void* rec);
+};
+
+#endif
@@ -0,0 +1,333 @@
+/**
+ * @file eefile_mirror.cpp
+ * @brief 镜像存储后端实现
+ */
+
+#include "eefile_mirror.h"
+
+EEMirrorBackend::EEMirrorBackend(EEBackend& primary, EEBackend& secondary, uint16_t crcAddr)
+    : crcAddr(crcAddr), src(0), repairs(0), errors(0)
+{
+    dev[0] = &primary;
+    dev[1] = &secondary;
+    devErrors[0] = 0;
+    devErrors[1] = 0;
+    memset(regions, 0, sizeof(regions));
+}
+
+// ============ 挂载：测量两个器件的读取耗时，选较快的作为读取源 ============
+void EEMirrorBackend::begin()
+{
+    uint8_t buf[16];
+    uint32_t cost[2];
+
+    for (uint8_t d = 0; d < 2; d++) {
+        dev[d]->begin();
+        uint32_t t = micros();
+        dev[d]->readBlock(crcAddr, buf, sizeof(buf));
+        cost[d] = micros() - t;
+    }
+    src = (cost[1] < cost[0]) ? 1 : 0;
+    devErrors[0] = dev[0]->getErrorCount();
+    devErrors[1] = dev[1]->getErrorCount();
+    FILE_DEBUG("[EEMIRROR] Read source: %s (%lu us vs %lu us)",
+        src ? "secondary" : "primary", (unsigned long)cost[src], (unsigned long)cost[src ^ 1]);
+}
+
+// ============ CRC 表 ============
+uint16_t EEMirrorBackend::storedCrc(uint8_t d, uint8_t id)
+{
+    uint8_t b[2];
+    dev[d]->readBlock(crcAddr + id * 2, b, 2);
+    return eep_get_u16(b);
+}
+
+void EEMirrorBackend::storeCrc(uint8_t d, uint8_t id, uint16_t crc)
+{
+    uint8_t b[2];
+    eep_put_u16(b, crc);
+    if (storedCrc(d, id) != crc) {
+        dev[d]->writeBlock(crcAddr + id * 2, b, 2);
+    }
+}
+
+// 分段读出整个文件计算 CRC
+uint16_t EEMirrorBackend::regionCrc(uint8_t d, const Region& r)
+{
+    uint8_t chunk[16];
+    uint16_t crc = 0xFFFF;
+    for (uint16_t off = 0; off < r.len; off += sizeof(chunk)) {
+        uint16_t n = r.len - off;
+        if (n > sizeof(chunk)) {
+            n = sizeof(chunk);
+        }
+        dev[d]->readBlock(r.addr + off, chunk, n);
+        for (uint16_t i = 0; i < n; i++) {
+            crc = eep_crc16_update(crc, chunk[i]);
+        }
+    }
+    return crc;
+}
+
+// ============ 注册：检查两份副本，记下需要修复的一份 ============
+bool EEMirrorBackend::mapRegion(uint8_t id, uint16_t addr, uint16_t len, uint8_t tier)
+{
+    if (addr < crcAddr + EEFILE_MIRROR_CRC_SIZE && crcAddr < addr + len) {
+        FILE_DEBUG("[EEMIRROR] ERROR: region %d overlaps the CRC table at 0x%04X", id, crcAddr);
+        return false;
+    }
+    if (tier != EEFILE_TIER_MIRROR) {
+        return dev[0]->mapRegion(id, addr, len, tier);
+    }
+    if (id >= EEFILE_MIRROR_REGIONS ||
+        !dev[0]->mapRegion(id, addr, len, EEFILE_TIER_SLOW) ||
+        !dev[1]->mapRegion(id, addr, len, EEFILE_TIER_SLOW)) {
+        return false;
+    }
+
+    Region& r = regions[id];
+    r.addr = addr;
+    r.len = len;
+    r.pending = false;
+    r.checked = true;
+    r.failed = false;
+    r.bad = 0;
+
+    uint16_t crc[2];
+    bool ok[2];
+    for (uint8_t d = 0; d < 2; d++) {
+        crc[d] = regionCrc(d, r);
+        ok[d] = (crc[d] == storedCrc(d, id));
+    }
+
+    if (ok[0] && ok[1]) {
+        if (crc[0] != crc[1]) {
+            r.bad = (src == 0) ? 0x02 : 0x01;   // 两份都完整但不同：以读取源为准
+        }
+    } else if (ok[0] || ok[1]) {
+        r.bad = ok[0] ? 0x02 : 0x01;
+    } else if (crc[0] == crc[1]) {
+        // 数据已写完、CRC 表未更新时掉电：两份一致，只补写 CRC
+        r.pending = true;
+    } else {
+        FILE_DEBUG("[EEMIRROR] ERROR: both copies of region %d corrupt", id);
+        errors++;
+        r.failed = true;
+    }
+    if (r.bad) {
+        FILE_DEBUG("[EEMIRROR] WARNING: region %d %s copy needs repair",
+            id, (r.bad & 0x01) ? "primary" : "secondary");
+    }
+    return true;
+}
+
+// ============ 路由 ============
+int8_t EEMirrorBackend::findMirror(uint16_t addr) const
+{
+    for (uint8_t i = 0; i < EEFILE_MIRROR_REGIONS; i++) {
+        if (regions[i].len && addr >= regions[i].addr && addr - regions[i].addr < regions[i].len) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 从 addr 开始、同属一类的连续字节数；*m 为镜像文件下标，普通数据为 -1
+uint16_t EEMirrorBackend::span(uint16_t addr, uint16_t len, int8_t* m) const
+{
+    *m = findMirror(addr);
+    if (*m >= 0) {
+        const Region& r = regions[*m];
+        uint16_t n = r.len - (addr - r.addr);
+        return (n < len) ? n : len;
+    }
+    uint16_t n = 1;
+    while (n < len && findMirror(addr + n) < 0) {
+        n++;
+    }
+    return n;
+}
+
+// 优先读较快的器件，它待修复时读另一份
+uint8_t EEMirrorBackend::pickSource(const Region& r) const
+{
+    return (r.bad & (1 << src)) ? (src ^ 1) : src;
+}
+
+uint8_t EEMirrorBackend::read(uint16_t addr)
+{
+    uint8_t v;
+    readBlock(addr, &v, 1);
+    return v;
+}
+
+void EEMirrorBackend::write(uint16_t addr, uint8_t value)
+{
+    writeBlock(addr, &value, 1);
+}
+
+// ============ 校验：每个文件在两次写入之间只校验一次 ============
+void EEMirrorBackend::check(uint8_t id)
+{
+    Region& r = regions[id];
+    uint8_t d = pickSource(r);
+    if (regionCrc(d, r) != storedCrc(d, id)) {
+        if (!(r.bad & (1 << (d ^ 1))) && regionCrc(d ^ 1, r) == storedCrc(d ^ 1, id)) {
+            r.bad |= 1 << d;
+        } else {
+            FILE_DEBUG("[EEMIRROR] ERROR: both copies of region %d corrupt", id);
+            r.failed = true;
+        }
+    }
+    r.checked = true;
+}
+
+void EEMirrorBackend::recheck(void)
+{
+    for (uint8_t i = 0; i < EEFILE_MIRROR_REGIONS; i++) {
+        regions[i].checked = false;
+    }
+}
+
+void EEMirrorBackend::readBlock(uint16_t addr, uint8_t* buf, uint16_t len)
+{
+    while (len > 0) {
+        int8_t m;
+        uint16_t n = span(addr, len, &m);
+        if (m < 0) {
+            dev[0]->readBlock(addr, buf, n);
+        } else {
+            Region& r = regions[m];
+            // 本次写操作中 CRC 尚未更新，直接读
+            if (!r.pending && !r.checked) {
+                check(m);
+            }
+            // 两份都不可信：按主后端读出并计错，核心据此判读取失败
+            dev[r.failed ? 0 : pickSource(r)]->readBlock(addr, buf, n);
+            if (r.failed) {
+                errors++;
+            }
+        }
+        buf += n;
+        addr += n;
+        len -= n;
+    }
+}
+
+// 副后端先写：它的写周期与主后端的写入重叠
+void EEMirrorBackend::writeBlock(uint16_t addr, const uint8_t* buf, uint16_t len)
+{
+    while (len > 0) {
+        int8_t m;
+        uint16_t n = span(addr, len, &m);
+        if (m >= 0) {
+            if (regions[m].failed) {
+                // 重新写入两份都损坏的文件：先让副本与主后端一致，核心按主后端的内容差分写
+                copyRegion(0, m);
+                regions[m].failed = false;
+                regions[m].bad = 0;
+            }
+            dev[1]->writeBlock(addr, buf, n);
+            regions[m].pending = true;
+        }
+        dev[0]->writeBlock(addr, buf, n);
+        buf += n;
+        addr += n;
+        len -= n;
+    }
+}
+
+uint16_t EEMirrorBackend::programUnit() const
+{
+    return dev[0]->programUnit();
+}
+
+bool EEMirrorBackend::coalesceWrites() const
+{
+    return dev[0]->coalesceWrites() || dev[1]->coalesceWrites();
+}
+
+// ============ 提交：更新 CRC 表（副后端先），然后修复 ============
+// 每份的 CRC 按它自己的内容计算：一份写入失败时它的 CRC 仍如实描述它
+void EEMirrorBackend::flush()
+{
+    for (uint8_t i = 0; i < EEFILE_MIRROR_REGIONS; i++) {
+        Region& r = regions[i];
+        if (!r.len || !r.pending) {
+            continue;
+        }
+        uint16_t crc[2] = { 0, 0 };
+        for (int8_t k = 1; k >= 0; k--) {
+            if (!(r.bad & (1 << k))) {
+                crc[k] = regionCrc(k, r);
+                storeCrc(k, i, crc[k]);
+            }
+        }
+        // 两份内容不同：只有一个器件报了写入错误时以另一份为准，否则以读取源为准
+        if (!r.bad && crc[0] != crc[1]) {
+            bool err0 = (dev[0]->getErrorCount() != devErrors[0]);
+            bool err1 = (dev[1]->getErrorCount() != devErrors[1]);
+            uint8_t good = (err0 != err1) ? (err0 ? 1 : 0) : src;
+            FILE_DEBUG("[EEMIRROR] WARNING: region %d copies differ after write", i);
+            r.bad = (good == 0) ? 0x02 : 0x01;
+        }
+        r.pending = false;
+        r.checked = true;               // CRC 刚由各自的内容算出，下次写入前不必再校验
+    }
+    repair();
+    dev[1]->flush();
+    dev[0]->flush();
+    devErrors[0] = dev[0]->getErrorCount();
+    devErrors[1] = dev[1]->getErrorCount();
+}
+
+void EEMirrorBackend::repair(void)
+{
+    for (uint8_t i = 0; i < EEFILE_MIRROR_REGIONS; i++) {
+        Region& r = regions[i];
+        if (!r.len || !r.bad || r.pending || r.failed) {
+            continue;
+        }
+        copyRegion((r.bad & 0x01) ? 1 : 0, i);
+        r.bad = 0;
+        repairs++;
+    }
+}
+
+// 只写不同的字节，最后写 CRC
+void EEMirrorBackend::copyRegion(uint8_t from, uint8_t id)
+{
+    const Region& r = regions[id];
+    uint8_t to = from ^ 1;
+    uint8_t a[16];
+    uint8_t b[16];
+    for (uint16_t off = 0; off < r.len; off += sizeof(a)) {
+        uint16_t n = r.len - off;
+        if (n > sizeof(a)) {
+            n = sizeof(a);
+        }
+        dev[from]->readBlock(r.addr + off, a, n);
+        dev[to]->readBlock(r.addr + off, b, n);
+        if (memcmp(a, b, n) != 0) {
+            dev[to]->writeBlock(r.addr + off, a, n);
+        }
+    }
+    storeCrc(to, id, storedCrc(from, id));
+    dev[to]->flush();
+    FILE_DEBUG("[EEMIRROR] Repaired region %d on %s", id, to ? "secondary" : "primary");
+}
+
+uint8_t EEMirrorBackend::getReadSource() const
+{
+    return src;
+}
+
+uint16_t EEMirrorBackend::getRepairCount() const
+{
+    return repairs;
+}
+
+uint16_t EEMirrorBackend::getErrorCount() const
+{
+    return errors;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file eefile_mirror.h
+ * @brief 镜像存储后端：关键文件在两个器件上各存一份
+ *
+ * 用 EE_REG_TIER(type, size, EEFILE_TIER_MIRROR) 注册的文件同时写入主、副两个
+ * 后端（如片内 EEPROM + 外部 I2C EEPROM），其它文件只在主后端。
+ *   - 写：先写副后端再写主后端。I2C 后端不等待写周期，两个器件的写周期重叠
+ *   - 写操作结束（flush）时更新两边的文件 CRC 表
+ *   - 读：从 begin() 时测得较快的器件读取。每个文件在下一次写入之前只校验一次整文件 CRC，
+ *         不符则改读另一份，并把坏的一份记下，在下一次 flush() 或 repair() 时修复；
+ *         两份都损坏时按主后端读出并计入 getErrorCount()，核心的读取返回失败，直到重新写入
+ *
+ * 每个器件在 crcAddr 处保存 EEFILE_MIRROR_CRC_SIZE 字节的 CRC 表，默认紧接在
+ * EEFILE_TOTAL_SIZE 之后；与之重叠的文件注册失败。器件容量不够时用
+ * -DEEFILE_NUM_SECTORS / -DEEFILE_SECTOR_SIZE 调小文件区。
+ */
+
+#ifndef __EEFILE_MIRROR__
+#define __EEFILE_MIRROR__
+
+#include "eefile.h"
+
+#define EEFILE_MIRROR_REGIONS   (EEFILE_MAX_FILES + 1)      // 文件 + 有效位图
+#define EEFILE_MIRROR_CRC_SIZE  (EEFILE_MIRROR_REGIONS * 2)
+
+class EEMirrorBackend : public EEBackend
+{
+  public:
+    /**
+     * @param primary 主后端，保存所有文件
+     * @param secondary 副后端，只保存镜像文件；有异步写周期的器件放这里
+     * @param crcAddr 两个器件上 CRC 表的地址，不能与文件区重叠
+     */
+    EEMirrorBackend(EEBackend& primary, EEBackend& secondary,
+        uint16_t crcAddr = EEFILE_TOTAL_SIZE);
+
+    void begin();
+    uint8_t read(uint16_t addr);
+    void write(uint16_t addr, uint8_t value);
+    void readBlock(uint16_t addr, uint8_t* buf, uint16_t len);
+    void writeBlock(uint16_t addr, const uint8_t* buf, uint16_t len);
+    uint16_t programUnit() const;
+    bool coalesceWrites() const;
+    bool mapRegion(uint8_t id, uint16_t addr, uint16_t len, uint8_t tier);
+    void flush();
+
+    /**
+     * @brief 用好的一份覆盖损坏的一份（flush() 时也会自动执行）
+     */
+    void repair(void);
+
+    /**
+     * @brief 丢弃缓存的校验结论，每个镜像文件在下次读取时重新校验（周期巡检时调用）
+     */
+    void recheck(void);
+
+    uint8_t getReadSource() const;      // 0 = 主后端，1 = 副后端
+    uint16_t getRepairCount() const;    // 已修复的副本数
+    uint16_t getErrorCount() const;     // 读到两份都损坏的文件的次数
+
+  private:
+    typedef struct {
+        uint16_t addr;
+        uint16_t len;                   // 0 表示不是镜像文件
+        bool pending;                   // 已写入数据，CRC 待更新
+        bool checked;                   // 上次写入以来已校验过，bad/failed 有效
+        bool failed;                    // 两份都校验失败
+        uint8_t bad;                    // 需要修复的副本（bit0 主，bit1 副）
+    } Region;
+
+    EEBackend* dev[2];
+    uint16_t crcAddr;
+    uint8_t src;
+
+    Region regions[EEFILE_MIRROR_REGIONS];
+    uint16_t repairs;
+    uint16_t errors;
+    uint16_t devErrors[2];              // 上次 flush 时两个器件的错误计数
+
+    int8_t findMirror(uint16_t addr) const;
+    uint16_t span(uint16_t addr, uint16_t len, int8_t* m) const;
+    uint8_t pickSource(const Region& r) const;
+    uint16_t storedCrc(uint8_t d, uint8_t id);
+    void storeCrc(uint8_t d, uint8_t id, uint16_t crc);
+    uint16_t regionCrc(uint8_t d, const Region& r);
+    void check(uint8_t id);
+    void copyRegion(uint8_t from, uint8_t id);
+};
+
+#endif
@@ -0,0 +1,384 @@
+/**
+ * @file eefile_pages.cpp
+ * @brief 多页轮换 EEPROM 模拟后端实现
+ */
+
+#include "eefile_pages.h"
+
+#if EEFILE_FLASH
+
+EEPageBackend::EEPageBackend(uintptr_t base, uint8_t pages, uint16_t pageSize,
+    uint16_t unit, uint8_t* stage, uint16_t stageSize)
+    : base(base), pages(pages), pageSize(pageSize), unit(unit),
+      stage(stage), stageSize(stageSize),
+      active(0), gen(0), writePtr(0), staged(0xFF), stageDirty(false),
+      programs(0), erases(0), transfers(0), errors(0)
+{
+    memset(regions, 0, sizeof(regions));
+    for (uint8_t i = 0; i < EEFILE_PAGES_REGIONS; i++) {
+        index[i] = EEFILE_PAGES_NONE;
+    }
+}
+
+// ============ 尺寸计算 ============
+uint16_t EEPageBackend::alignUp(uint16_t n) const
+{
+    return ((n + unit - 1) / unit) * unit;
+}
+
+uint16_t EEPageBackend::recordSize(uint16_t len) const
+{
+    return alignUp(4 + len) + alignUp(2);
+}
+
+uintptr_t EEPageBackend::pageAddr(uint8_t page) const
+{
+    return base + (uintptr_t)page * pageSize;
+}
+
+uint16_t EEPageBackend::recordLen(uint16_t off) const
+{
+    const volatile uint8_t* p = (const volatile uint8_t*)(pageAddr(active) + off);
+    return p[2] | ((uint16_t)p[3] << 8);
+}
+
+int8_t EEPageBackend::findRegion(uint16_t addr) const
+{
+    for (uint8_t i = 0; i < EEFILE_PAGES_REGIONS; i++) {
+        if (regions[i].len && addr >= regions[i].addr && addr - regions[i].addr < regions[i].len) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// ============ 挂载：找活动页并建立索引 ============
+void EEPageBackend::begin()
+{
+    scan();
+    staged = 0xFF;
+    stageDirty = false;
+    FILE_DEBUG("[EEPAGES] Active page %d (gen %u), %u bytes free",
+        active, gen, pageSize - writePtr);
+}
+
+void EEPageBackend::scan(void)
+{
+    uint8_t found = 0xFF;
+    for (uint8_t p = 0; p < pages; p++) {
+        const volatile uint8_t* h = (const volatile uint8_t*)pageAddr(p);
+        uint16_t magic = h[0] | ((uint16_t)h[1] << 8);
+        uint16_t g = h[2] | ((uint16_t)h[3] << 8);
+        if (magic == EEFILE_PAGES_MAGIC && (found == 0xFF || (int16_t)(g - gen) > 0)) {
+            found = p;
+            gen = g;
+        }
+    }
+    if (found == 0xFF) {
+        formatPage(0, 1);
+        found = 0;
+        gen = 1;
+    }
+    active = found;
+
+    for (uint8_t i = 0; i < EEFILE_PAGES_REGIONS; i++) {
+        index[i] = EEFILE_PAGES_NONE;
+    }
+
+    // 顺序扫描记录：遇到擦除态为结尾；记录头损坏则本页剩余空间不再使用
+    uint16_t off = alignUp(4);
+    while (off + 4 <= pageSize) {
+        const volatile uint8_t* p = (const volatile uint8_t*)(pageAddr(active) + off);
+        uint8_t id = p[0];
+        uint16_t len = p[2] | ((uint16_t)p[3] << 8);
+        if (id == 0xFF && p[1] == 0xFF && len == 0xFFFF) {
+            break;
+        }
+        if ((uint8_t)(id ^ p[1]) != 0xFF || recordSize(len) > pageSize - off) {
+            FILE_DEBUG("[EEPAGES] WARNING: corrupt record at 0x%04X", off);
+            off = pageSize;
+            break;
+        }
+
+        uint16_t crc = 0xFFFF;
+        for (uint16_t i = 0; i < 4 + len; i++) {
+            crc = eep_crc16_update(crc, p[i]);
+        }
+        const volatile uint8_t* c = p + alignUp(4 + len);
+        if ((c[0] | ((uint16_t)c[1] << 8)) == crc && id < EEFILE_PAGES_REGIONS) {
+            index[id] = off;
+        } else {
+            FILE_DEBUG("[EEPAGES] WARNING: torn record (id %d) at 0x%04X", id, off);
+        }
+        off += recordSize(len);
+    }
+    writePtr = off;
+}
+
+// ============ 读：按索引直接定位 ============
+uint8_t EEPageBackend::fetch(uint8_t id, uint16_t pos)
+{
+    if (id == staged) {
+        return stage[4 + pos];
+    }
+    uint16_t off = index[id];
+    if (off == EEFILE_PAGES_NONE || pos >= recordLen(off)) {
+        return 0xFF;
+    }
+    return *(const volatile uint8_t*)(pageAddr(active) + off + 4 + pos);
+}
+
+uint8_t EEPageBackend::read(uint16_t addr)
+{
+    int8_t r = findRegion(addr);
+    return (r < 0) ? 0xFF : fetch(r, addr - regions[r].addr);
+}
+
+void EEPageBackend::readBlock(uint16_t addr, uint8_t* buf, uint16_t len)
+{
+    while (len > 0) {
+        int8_t r = findRegion(addr);
+        if (r < 0) {
+            *buf++ = 0xFF;
+            addr++;
+            len--;
+            continue;
+        }
+        uint16_t pos = addr - regions[r].addr;
+        uint16_t n = regions[r].len - pos;
+        if (n > len) {
+            n = len;
+        }
+        for (uint16_t i = 0; i < n; i++) {
+            buf[i] = fetch(r, pos + i);
+        }
+        buf += n;
+        addr += n;
+        len -= n;
+    }
+}
+
+// ============ 写：先进暂存，flush 时整条追加 ============
+void EEPageBackend::loadStage(uint8_t id)
+{
+    if (staged == id) {
+        return;
+    }
+    flush();
+    if (stageDirty) {
+        // 上一个文件两次提交都失败（已计入错误）：放弃它，暂存让给新文件
+        FILE_DEBUG("[EEPAGES] ERROR: file %d dropped from stage", staged);
+    }
+    staged = 0xFF;
+    for (uint16_t i = 0; i < regions[id].len; i++) {
+        stage[4 + i] = fetch(id, i);
+    }
+    staged = id;
+    stageDirty = false;
+}
+
+void EEPageBackend::write(uint16_t addr, uint8_t value)
+{
+    writeBlock(addr, &value, 1);
+}
+
+void EEPageBackend::writeBlock(uint16_t addr, const uint8_t* buf, uint16_t len)
+{
+    while (len > 0) {
+        int8_t r = findRegion(addr);
+        if (r < 0) {
+            FILE_DEBUG("[EEPAGES] ERROR: 0x%04X not in any file", addr);
+            errors++;
+            return;
+        }
+        uint16_t pos = addr - regions[r].addr;
+        uint16_t n = regions[r].len - pos;
+        if (n > len) {
+            n = len;
+        }
+        loadStage(r);
+        memcpy(stage + 4 + pos, buf, n);
+        stageDirty = true;
+        buf += n;
+        addr += n;
+        len -= n;
+    }
+}
+
+void EEPageBackend::flush()
+{
+    if (staged == 0xFF || !stageDirty) {
+        return;
+    }
+    uint16_t len = regions[staged].len;
+    if (recordSize(len) > pageSize - writePtr) {
+        // 新记录随搬运一起写入目标页；失败时旧页与旧记录保持不变，暂存保留待重试
+        if (transfer()) {
+            stageDirty = false;
+        } else {
+            errors++;
+        }
+        return;
+    }
+    // 追加失败：记录头可能只写了一部分，挂载扫描到这里就会停下，
+    // 本页剩余空间不再使用；暂存保留，下次 flush 随搬运写入新页
+    if (!appendRecord(active, writePtr, staged, stage + 4, len)) {
+        errors++;
+        writePtr = pageSize;
+        return;
+    }
+    index[staged] = writePtr;
+    writePtr += recordSize(len);
+    stageDirty = false;
+}
+
+bool EEPageBackend::mapRegion(uint8_t id, uint16_t addr, uint16_t len, uint8_t tier)
+{
+    if (tier != EEFILE_TIER_SLOW) {
+        return false;
+    }
+    if (id >= EEFILE_PAGES_REGIONS || alignUp(4 + len) > stageSize) {
+        FILE_DEBUG("[EEPAGES] ERROR: region %d (%d bytes) exceeds stage buffer", id, len);
+        return false;
+    }
+    regions[id].addr = addr;
+    regions[id].len = len;
+    return true;
+}
+
+uint16_t EEPageBackend::programUnit() const
+{
+    return unit;
+}
+
+// ============ Flash 编程 ============
+bool EEPageBackend::programBytes(uintptr_t addr, const uint8_t* data, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i += unit) {
+        if (!eefile_flash_program(addr + i, data + i, unit)) {
+            FILE_DEBUG("[EEPAGES] ERROR: program failed");
+            return false;
+        }
+        programs++;
+    }
+    return true;
+}
+
+// 记录头和数据先写，CRC 最后写；CRC 不符的记录在挂载时被忽略
+bool EEPageBackend::appendRecord(uint8_t page, uint16_t off, uint8_t id,
+    const uint8_t* data, uint16_t len)
+{
+    uint16_t body = alignUp(4 + len);
+    uint16_t crc = 0xFFFF;
+    uint8_t tail[8];
+
+    stage[0] = id;
+    stage[1] = ~id;
+    stage[2] = len & 0xFF;
+    stage[3] = len >> 8;
+    if (data != stage + 4) {
+        memcpy(stage + 4, data, len);
+    }
+    memset(stage + 4 + len, 0xFF, body - 4 - len);
+    for (uint16_t i = 0; i < 4 + len; i++) {
+        crc = eep_crc16_update(crc, stage[i]);
+    }
+
+    memset(tail, 0xFF, sizeof(tail));
+    eep_put_u16(tail, crc);
+    return programBytes(pageAddr(page) + off, stage, body) &&
+           programBytes(pageAddr(page) + off + body, tail, alignUp(2));
+}
+
+bool EEPageBackend::formatPage(uint8_t page, uint16_t newGen)
+{
+    uint8_t head[8];
+    if (!eefile_flash_erase(pageAddr(page), pageSize)) {
+        return false;
+    }
+    erases++;
+    memset(head, 0xFF, sizeof(head));
+    eep_put_u16(head, EEFILE_PAGES_MAGIC);
+    eep_put_u16(head + 2, newGen);
+    return programBytes(pageAddr(page), head, alignUp(4));
+}
+
+// ============ 页搬运 ============
+// 擦除下一页，复制每个文件的最新记录；暂存中待写的文件直接写入新记录。
+// 页头最后写：页头写入前掉电或任何一步失败，挂载时仍选择旧页，旧记录都还在
+bool EEPageBackend::transfer(void)
+{
+    uint8_t target = (active + 1) % pages;
+    uint16_t newIndex[EEFILE_PAGES_REGIONS];
+    uint16_t off = alignUp(4);
+
+    if (!eefile_flash_erase(pageAddr(target), pageSize)) {
+        FILE_DEBUG("[EEPAGES] ERROR: erase failed");
+        return false;
+    }
+    erases++;
+
+    for (uint8_t id = 0; id < EEFILE_PAGES_REGIONS; id++) {
+        newIndex[id] = EEFILE_PAGES_NONE;
+        bool fresh = (id == staged && stageDirty);
+        if (index[id] == EEFILE_PAGES_NONE && !fresh) {
+            continue;
+        }
+        uint16_t size = recordSize(fresh ? regions[id].len : recordLen(index[id]));
+        if (size > pageSize - off) {
+            FILE_DEBUG("[EEPAGES] ERROR: live data exceeds one page");
+            return false;
+        }
+        bool ok = fresh ? appendRecord(target, off, id, stage + 4, regions[id].len)
+                        : programBytes(pageAddr(target) + off,
+                              (const uint8_t*)(pageAddr(active) + index[id]), size);
+        if (!ok) {
+            return false;
+        }
+        newIndex[id] = off;
+        off += size;
+    }
+
+    uint8_t head[8];
+    memset(head, 0xFF, sizeof(head));
+    eep_put_u16(head, EEFILE_PAGES_MAGIC);
+    eep_put_u16(head + 2, gen + 1);
+    if (!programBytes(pageAddr(target), head, alignUp(4))) {
+        return false;
+    }
+
+    active = target;
+    gen++;
+    memcpy(index, newIndex, sizeof(index));
+    writePtr = off;
+    transfers++;
+    FILE_DEBUG("[EEPAGES] Transfer to page %d (gen %u)", active, gen);
+    return true;
+}
+
+uint32_t EEPageBackend::getProgramCount() const
+{
+    return programs;
+}
+
+uint32_t EEPageBackend::getEraseCount() const
+{
+    return erases;
+}
+
+uint16_t EEPageBackend::getTransferCount() const
+{
+    return transfers;
+}
+
+uint16_t EEPageBackend::getFreeSpace() const
+{
+    return pageSize - writePtr;
+}
+
+uint16_t EEPageBackend::getErrorCount() const
+{
+    return errors;
+}
+
+#endif
@@ -0,0 +1,108 @@
+/**
+ * @file eefile_pages.h
+ * @brief 多页轮换 EEPROM 模拟后端：按文件追加记录，写满后搬运有效记录到下一页
+ *
+ * 直接在 N（≥2）个 Flash 页上模拟 EEPROM，不依赖厂商的模拟层：
+ *   页头：[magic u16][代数 u16]，代数最大的有效页为活动页
+ *   记录：[文件 id][~id][长度 u16][数据][填充][CRC16][填充]，均按编程单位对齐
+ * 每次公共写操作结束（flush）把文件的新内容作为一条记录追加到活动页。
+ * 活动页放不下时，把每个文件的最新记录连同待写的新记录搬到下一页（擦除后写入，页头最后写），
+ * 掉电时旧页仍然完整。
+ * begin() 扫描一次活动页，建立“文件 -> 最新记录偏移”的 RAM 索引，之后读取
+ * 直接按索引定位，不再扫描。
+ *
+ * 编程/擦除使用 eefile_flash.h 中的 eefile_flash_program() / eefile_flash_erase()。
+ */
+
+#ifndef __EEFILE_PAGES__
+#define __EEFILE_PAGES__
+
+#include "eefile.h"
+#include "eefile_flash.h"
+
+#if EEFILE_FLASH
+
+#define EEFILE_PAGES_MAGIC      0x5045      // "EP"
+#define EEFILE_PAGES_REGIONS    (EEFILE_MAX_FILES + 1)      // 文件 + 有效位图
+#define EEFILE_PAGES_NONE       0xFFFF
+
+// 暂存缓冲大小：最大文件（含标记）+ 记录头，按编程单位取整
+#define EEFILE_PAGES_STAGE(maxRegion, unit) \
+    ((((maxRegion) + 4 + (unit) - 1) / (unit)) * (unit))
+
+class EEPageBackend : public EEBackend
+{
+  public:
+    /**
+     * @param base 第一页的地址
+     * @param pages 页数（≥2，连续）
+     * @param pageSize 擦除页大小
+     * @param unit 编程单位：1/2/4/8 字节
+     * @param stage 暂存缓冲，大小用 EEFILE_PAGES_STAGE(最大文件, unit)
+     * @param stageSize 暂存缓冲大小
+     */
+    EEPageBackend(uintptr_t base, uint8_t pages, uint16_t pageSize, uint16_t unit,
+        uint8_t* stage, uint16_t stageSize);
+
+    void begin();
+    uint8_t read(uint16_t addr);
+    void write(uint16_t addr, uint8_t value);
+    void readBlock(uint16_t addr, uint8_t* buf, uint16_t len);
+    void writeBlock(uint16_t addr, const uint8_t* buf, uint16_t len);
+    uint16_t programUnit() const;
+    bool mapRegion(uint8_t id, uint16_t addr, uint16_t len, uint8_t tier);
+    void flush();
+
+    uint32_t getProgramCount() const;   // 编程操作次数
+    uint32_t getEraseCount() const;     // 页擦除次数
+    uint16_t getTransferCount() const;  // 页搬运次数
+    uint16_t getFreeSpace() const;      // 活动页剩余字节
+    uint16_t getErrorCount() const;     // 追加/搬运失败次数
+
+  private:
+    typedef struct {
+        uint16_t addr;
+        uint16_t len;                   // 0 表示未映射
+    } Region;
+
+    uintptr_t base;
+    uint8_t pages;
+    uint16_t pageSize;
+    uint16_t unit;
+    uint8_t* stage;                     // [记录头 4 字节][文件内容]
+    uint16_t stageSize;
+
+    Region regions[EEFILE_PAGES_REGIONS];
+    uint16_t index[EEFILE_PAGES_REGIONS];   // 活动页内最新记录的偏移
+    uint8_t active;
+    uint16_t gen;
+    uint16_t writePtr;
+    uint8_t staged;                     // 暂存中的文件 id，0xFF 表示无
+    bool stageDirty;
+
+    uint32_t programs;
+    uint32_t erases;
+    uint16_t transfers;
+    uint16_t errors;
+
+    uint16_t alignUp(uint16_t n) const;
+    uint16_t recordSize(uint16_t len) const;
+    uintptr_t pageAddr(uint8_t page) const;
+    int8_t findRegion(uint16_t addr) const;
+    uint16_t recordLen(uint16_t off) const;
+    uint8_t fetch(uint8_t id, uint16_t pos);
+    void loadStage(uint8_t id);
+    bool programBytes(uintptr_t addr, const uint8_t* data, uint16_t len);
+    bool appendRecord(uint8_t page, uint16_t off, uint8_t id, const uint8_t* data, uint16_t len);
+    bool transfer(void);
+    bool formatPage(uint8_t page, uint16_t newGen);
+    void scan(void);
+};
+
+#define EEFILE_PAGE_BACKEND(name, base, pages, pageSize, unit, maxRegion) \
+    static uint8_t name##_stage[EEFILE_PAGES_STAGE(maxRegion, unit)];      \
+    EEPageBackend name(base, pages, pageSize, unit, name##_stage, sizeof(name##_stage))
+
+#endif
+
+#endif
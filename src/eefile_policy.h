@@ -0,0 +1,123 @@
+/**
+ * @file eefile_policy.h
+ * @brief 按文件选择存储策略：注册时传入策略描述，读写由策略的操作表完成
+ * @note 需要在编译选项中定义 EEFILE_POLICY=1
+ *
+ * 策略编号与 eefile_proto.h 的 EEP_POLICY_* 一致（ee_tune 推荐结果可直接对照）：
+ *   写直通     EE_POLICY_WRITE_THROUGH   默认方案，每次 write 差分编程
+ *   回写缓存   EE_POLICY_WRITE_BACK      写入只进 RAM，超过周期或 EE.flush() 时写回
+ *   A/B 原子   EE_POLICY_AB              两份副本交替写，[序号][数据][CRC]，掉电保留旧值
+ *   日志结构   EE_POLICY_LOG             N 个槽轮流写，磨损降为 1/N
+ *   计数器     EE_POLICY_COUNTER         单调递增的 u32，N 个 5 字节槽轮流写
+ *   只读默认值 EE_POLICY_DEFAULTS        读取编译期默认值，不占存储、不可写
+ *
+ * 每种策略的操作表在单独的 .cpp 中定义，核心只通过函数指针调用，
+ * 未使用的策略不会被链接（-ffunction-sections / --gc-sections，Arduino 默认开启）。
+ *
+ * 用法：
+ *   EE_POLICY_AB(calPolicy, sizeof(Cal));
+ *   EE_POLICY_WRITE_BACK(statePolicy, sizeof(State), 60000UL);
+ *   EE_POLICY_COUNTER(bootPolicy, 8);
+ *   EE_REG_POLICY(CAL, calPolicy);
+ *   EE_REG_POLICY(STATE, statePolicy);
+ *   EE_REG_POLICY(BOOTS, bootPolicy);
+ *   EE_WRITE(CAL, &cal, sizeof(cal));          // 与普通文件相同
+ *   loop() { EE.service(); }                   // 到期的回写缓存在这里写回
+ */
+
+#ifndef __EEFILE_POLICY__
+#define __EEFILE_POLICY__
+
+#include "eefile.h"
+
+#if EEFILE_POLICY
+
+// ============ 策略操作表 ============
+typedef struct {
+    uint8_t id;                                                 // EEP_POLICY_*
+    uint16_t (*footprint)(const EEPolicy& p);                   // 在文件区占用的字节数
+    void (*mount)(EEPolicyIO& io, EEPolicy& p);                 // 从存储恢复运行状态
+    bool (*read)(EEPolicyIO& io, EEPolicy& p, uint8_t* data, uint16_t len);
+    bool (*write)(EEPolicyIO& io, EEPolicy& p, const uint8_t* data, uint16_t len);
+    void (*flush)(EEPolicyIO& io, EEPolicy& p, bool force);     // 可为 NULL
+} EEPolicyOps;
+
+// ============ 策略描述（配置 + 策略维护的运行状态）============
+struct EEPolicy {
+    const EEPolicyOps* ops;     // NULL 表示写直通（核心默认方案）
+    uint16_t size;              // 用户数据大小
+    uint8_t slots;              // A/B、日志、计数器的槽数
+    uint32_t flushMs;           // 回写周期
+    uint8_t* cache;             // 回写缓存，size 字节
+    const void* defaults;       // 只读默认值，size 字节
+
+    bool mounted;
+    bool hasData;               // 存储（或缓存）中有数据
+    bool dirty;                 // 回写：缓存有未写回的内容
+    uint8_t slot;               // 当前槽
+    uint16_t seq;               // A/B、日志：当前槽的序号
+    uint32_t value;             // 回写：首次变脏的时间；计数器：当前值
+};
+
+extern const EEPolicyOps EEPolicyWriteBack;
+extern const EEPolicyOps EEPolicyAB;
+extern const EEPolicyOps EEPolicyLog;
+extern const EEPolicyOps EEPolicyCounter;
+extern const EEPolicyOps EEPolicyDefaults;
+
+// ============ 定义策略描述 ============
+#define EE_POLICY_WRITE_THROUGH(name, size) \
+    EEPolicy name = { NULL, size, 0, 0, NULL, NULL }
+#define EE_POLICY_WRITE_BACK(name, size, flushMs) \
+    static uint8_t name##_cache[size];          \
+    EEPolicy name = { &EEPolicyWriteBack, size, 0, flushMs, name##_cache, NULL }
+#define EE_POLICY_AB(name, size) \
+    EEPolicy name = { &EEPolicyAB, size, 2, 0, NULL, NULL }
+#define EE_POLICY_LOG(name, size, slots) \
+    EEPolicy name = { &EEPolicyLog, size, slots, 0, NULL, NULL }
+#define EE_POLICY_COUNTER(name, slots) \
+    EEPolicy name = { &EEPolicyCounter, 4, slots, 0, NULL, NULL }
+#define EE_POLICY_DEFAULTS(name, defaults) \
+    EEPolicy name = { &EEPolicyDefaults, sizeof(defaults), 0, 0, NULL, &(defaults) }
+
+#define EE_REG_POLICY(type, policy) EE.registerPolicy(type, policy)
+
+// ============ 策略访问文件区的原始接口（任意实例）============
+// 核心调用操作表前构造，绑定到一个实例的一个文件
+template <class Fs>
+class EEPolicyPort : public EEPolicyIO
+{
+  public:
+    EEPolicyPort(Fs& fs, uint8_t idx) : fs(fs), idx(idx) {}
+
+    void read(uint16_t off, uint8_t* buf, uint16_t len)
+    {
+        fs.ioReadBlock(fs.files[idx].startAddr + EEFILE_MARKER_SIZE + off, buf, len);
+    }
+
+    void write(uint16_t off, const uint8_t* data, uint16_t len, uint16_t total)
+    {
+        fs.updateBlock(idx, fs.files[idx].startAddr + EEFILE_MARKER_SIZE + off, data, len, total);
+    }
+
+    bool valid(void)
+    {
+        return fs.markerValid(idx);
+    }
+
+    void setValid(bool valid)
+    {
+        fs.setMarker(idx, valid);
+    }
+
+  private:
+    Fs& fs;
+    uint8_t idx;
+};
+
+// 槽式策略（A/B、日志）共用：[序号 u16][数据 size 字节][CRC16]
+#define EEPOLICY_SLOT_OVERHEAD 4
+
+#endif
+
+#endif
@@ -0,0 +1,92 @@
+/**
+ * @file eefile_policy_counter.cpp
+ * @brief 计数器策略：单调递增的 u32（小端），N 个槽轮流写，磨损降为 1/N
+ *
+ * 每槽 [值 u32][校验 1 字节]，值越大越新，不需要序号；校验最后写入，
+ * 写到一半掉电的槽被忽略，读出上一个值。写入比当前值小的值会失败，
+ * 擦除（EE_ERASE）之后可以从任意值重新开始。
+ */
+
+#include "eefile_policy.h"
+
+#if EEFILE_POLICY
+
+#define COUNTER_SLOT_SIZE 5
+
+static uint8_t counterCheck(const uint8_t* b)
+{
+    uint16_t crc = 0xFFFF;
+    for (uint8_t i = 0; i < 4; i++) {
+        crc = eep_crc16_update(crc, b[i]);
+    }
+    return (uint8_t)crc;                    // 擦除态 FF FF FF FF 的校验为 0x0F，不会被误认
+}
+
+static uint16_t counterFootprint(const EEPolicy& p)
+{
+    return p.slots * COUNTER_SLOT_SIZE;
+}
+
+// p.value 为所有有效槽中的最大值（文件无效时也保留，用于判断是否需要清空）
+static void counterMount(EEPolicyIO& io, EEPolicy& p)
+{
+    bool found = false;
+    uint8_t b[COUNTER_SLOT_SIZE];
+    p.slot = p.slots - 1;
+    p.value = 0;
+    for (uint8_t i = 0; i < p.slots; i++) {
+        io.read(i * COUNTER_SLOT_SIZE, b, sizeof(b));
+        uint32_t v = eep_get_u32(b);
+        if (b[4] == counterCheck(b) && (!found || v > p.value)) {
+            found = true;
+            p.slot = i;
+            p.value = v;
+        }
+    }
+    p.hasData = found && io.valid();
+}
+
+static bool counterRead(EEPolicyIO& io, EEPolicy& p, uint8_t* data, uint16_t len)
+{
+    (void)io;
+    uint8_t b[4];
+    if (!p.hasData) {
+        return false;
+    }
+    eep_put_u32(b, p.value);
+    memcpy(data, b, len);
+    return true;
+}
+
+static bool counterWrite(EEPolicyIO& io, EEPolicy& p, const uint8_t* data, uint16_t len)
+{
+    uint8_t b[COUNTER_SLOT_SIZE] = {0, 0, 0, 0, 0};
+    memcpy(b, data, len);
+    uint32_t v = eep_get_u32(b);
+
+    if (p.hasData && v <= p.value) {
+        return v == p.value;                // 相同值不写，回退失败
+    }
+    if (v < p.value) {
+        // 擦除后从更小的值重新开始：先清空旧槽，否则挂载时旧的大值胜出
+        io.write(0, NULL, 0, counterFootprint(p));
+        p.slot = p.slots - 1;
+    }
+
+    uint8_t next = (p.slot + 1) % p.slots;
+    b[4] = counterCheck(b);
+    io.write(next * COUNTER_SLOT_SIZE, b, 4, 4);
+    io.write(next * COUNTER_SLOT_SIZE + 4, b + 4, 1, 1);
+    io.setValid(true);
+
+    p.slot = next;
+    p.value = v;
+    p.hasData = true;
+    return true;
+}
+
+const EEPolicyOps EEPolicyCounter = {
+    EEP_POLICY_COUNTER, counterFootprint, counterMount, counterRead, counterWrite, NULL
+};
+
+#endif
@@ -0,0 +1,42 @@
+/**
+ * @file eefile_policy_defaults.cpp
+ * @brief 只读默认值策略：读取编译期常量，不占存储、不产生磨损，写入失败
+ */
+
+#include "eefile_policy.h"
+
+#if EEFILE_POLICY
+
+static uint16_t defaultsFootprint(const EEPolicy& p)
+{
+    (void)p;
+    return 0;
+}
+
+static void defaultsMount(EEPolicyIO& io, EEPolicy& p)
+{
+    (void)io;
+    p.hasData = true;
+}
+
+static bool defaultsRead(EEPolicyIO& io, EEPolicy& p, uint8_t* data, uint16_t len)
+{
+    (void)io;
+    memcpy(data, p.defaults, len);
+    return true;
+}
+
+static bool defaultsWrite(EEPolicyIO& io, EEPolicy& p, const uint8_t* data, uint16_t len)
+{
+    (void)io;
+    (void)p;
+    (void)data;
+    (void)len;
+    return false;
+}
+
+const EEPolicyOps EEPolicyDefaults = {
+    EEP_POLICY_DEFAULTS, defaultsFootprint, defaultsMount, defaultsRead, defaultsWrite, NULL
+};
+
+#endif
@@ -0,0 +1,109 @@
+/**
+ * @file eefile_policy_slots.cpp
+ * @brief 槽式策略：A/B 原子（2 槽）与日志结构（N 槽）
+ *
+ * 每槽 [序号 u16][数据 size 字节][CRC16]，每次写入下一个槽，CRC 最后写入。
+ * 挂载时取 CRC 正确且序号最新的槽；写到一半掉电的槽 CRC 不符，旧槽仍然有效。
+ */
+
+#include "eefile_policy.h"
+
+#if EEFILE_POLICY
+
+static uint16_t slotSize(const EEPolicy& p)
+{
+    return p.size + EEPOLICY_SLOT_OVERHEAD;
+}
+
+static uint16_t slotsFootprint(const EEPolicy& p)
+{
+    return p.slots * slotSize(p);
+}
+
+// 读一个槽并校验 CRC
+static bool slotsCheck(EEPolicyIO& io, const EEPolicy& p, uint8_t slot, uint16_t* seq)
+{
+    uint8_t buf[16];
+    uint16_t base = slot * slotSize(p);
+    uint16_t crc = 0xFFFF;
+
+    io.read(base, buf, 2);
+    *seq = eep_get_u16(buf);
+    for (uint16_t off = 0; off < p.size + 2; off += sizeof(buf)) {
+        uint16_t n = p.size + 2 - off;
+        if (n > sizeof(buf)) {
+            n = sizeof(buf);
+        }
+        io.read(base + off, buf, n);
+        for (uint16_t i = 0; i < n; i++) {
+            crc = eep_crc16_update(crc, buf[i]);
+        }
+    }
+    io.read(base + 2 + p.size, buf, 2);
+    return eep_get_u16(buf) == crc;
+}
+
+// 取序号最新的有效槽（序号按 16 位回绕比较）；没有有效槽时下一次写槽 0
+static void slotsMount(EEPolicyIO& io, EEPolicy& p)
+{
+    bool found = false;
+    p.slot = p.slots - 1;
+    p.seq = 0;
+    for (uint8_t i = 0; i < p.slots; i++) {
+        uint16_t seq;
+        if (slotsCheck(io, p, i, &seq) && (!found || (int16_t)(seq - p.seq) > 0)) {
+            found = true;
+            p.slot = i;
+            p.seq = seq;
+        }
+    }
+    p.hasData = found && io.valid();
+}
+
+static bool slotsRead(EEPolicyIO& io, EEPolicy& p, uint8_t* data, uint16_t len)
+{
+    if (!p.hasData) {
+        return false;
+    }
+    io.read(p.slot * slotSize(p) + 2, data, len);
+    return true;
+}
+
+static bool slotsWrite(EEPolicyIO& io, EEPolicy& p, const uint8_t* data, uint16_t len)
+{
+    uint8_t next = (p.slot + 1) % p.slots;
+    uint16_t seq = p.seq + 1;
+    uint16_t base = next * slotSize(p);
+    uint8_t head[2];
+    uint8_t tail[2];
+    uint16_t crc = 0xFFFF;
+
+    eep_put_u16(head, seq);
+    crc = eep_crc16_update(crc, head[0]);
+    crc = eep_crc16_update(crc, head[1]);
+    for (uint16_t i = 0; i < p.size; i++) {
+        crc = eep_crc16_update(crc, (i < len) ? data[i] : 0xFF);
+    }
+    eep_put_u16(tail, crc);
+
+    // 序号和数据先写，CRC 最后写
+    io.write(base, head, sizeof(head), sizeof(head));
+    io.write(base + 2, data, len, p.size);
+    io.write(base + 2 + p.size, tail, sizeof(tail), sizeof(tail));
+    io.setValid(true);
+
+    p.slot = next;
+    p.seq = seq;
+    p.hasData = true;
+    return true;
+}
+
+const EEPolicyOps EEPolicyAB = {
+    EEP_POLICY_AB_ATOMIC, slotsFootprint, slotsMount, slotsRead, slotsWrite, NULL
+};
+
+const EEPolicyOps EEPolicyLog = {
+    EEP_POLICY_LOG, slotsFootprint, slotsMount, slotsRead, slotsWrite, NULL
+};
+
+#endif
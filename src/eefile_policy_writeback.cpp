@@ -0,0 +1,68 @@
+/**
+ * @file eefile_policy_writeback.cpp
+ * @brief 回写缓存策略：写入只改 RAM 缓存，到期（或 EE.flush()）时整块差分写回
+ */
+
+#include "eefile_policy.h"
+
+#if EEFILE_POLICY
+
+static uint16_t wbFootprint(const EEPolicy& p)
+{
+    return p.size;
+}
+
+static void wbMount(EEPolicyIO& io, EEPolicy& p)
+{
+    p.hasData = io.valid();
+    if (p.hasData) {
+        io.read(0, p.cache, p.size);
+    }
+}
+
+static void wbFlush(EEPolicyIO& io, EEPolicy& p, bool force)
+{
+    if (!p.dirty || (!force && millis() - p.value < p.flushMs)) {
+        return;
+    }
+    io.write(0, p.cache, p.size, p.size);
+    io.setValid(true);
+    p.dirty = false;
+}
+
+static bool wbRead(EEPolicyIO& io, EEPolicy& p, uint8_t* data, uint16_t len)
+{
+    (void)io;
+    if (!p.hasData) {
+        return false;
+    }
+    memcpy(data, p.cache, len);
+    return true;
+}
+
+// 与缓存相同的写入不会弄脏缓存；周期为 0 或已到期时立即写回
+static bool wbWrite(EEPolicyIO& io, EEPolicy& p, const uint8_t* data, uint16_t len)
+{
+    bool same = p.hasData && memcmp(p.cache, data, len) == 0;
+    for (uint16_t i = len; same && i < p.size; i++) {
+        same = (p.cache[i] == 0xFF);
+    }
+    if (same) {
+        return true;
+    }
+    memcpy(p.cache, data, len);
+    memset(p.cache + len, 0xFF, p.size - len);
+    p.hasData = true;
+    if (!p.dirty) {
+        p.dirty = true;
+        p.value = millis();
+    }
+    wbFlush(io, p, false);
+    return true;
+}
+
+const EEPolicyOps EEPolicyWriteBack = {
+    EEP_POLICY_WRITE_BACK, wbFootprint, wbMount, wbRead, wbWrite, wbFlush
+};
+
+#endif
@@ -0,0 +1,142 @@
+/**
+ * @file eefile_proto.h
+ * @brief EEFILE 串口二进制协议定义（设备端与主机端共用）
+ * @note 本文件只依赖 <stdint.h>，主机工具可直接包含
+ *
+ * 帧格式（小端）：
+ *   [0xEE] [cmd] [len_lo] [len_hi] [payload: len 字节] [crc_lo] [crc_hi]
+ *   crc = CRC16-CCITT(0xFFFF) 覆盖 cmd + len + payload
+ */
+
+#ifndef __EEFILE_PROTO__
+#define __EEFILE_PROTO__
+#include <stdint.h>
+
+#define EEP_SOF             0xEE    // 帧起始字节
+#define EEP_HEADER_SIZE     4       // SOF + cmd + len(2)
+#define EEP_MAX_PAYLOAD     128     // 单帧最大负载
+
+// ============ 主机 -> 设备 ============
+#define EEP_CMD_SYNC_REQ    0x01    // 请求增量：发送自上次确认以来的变化
+#define EEP_CMD_SYNC_FULL   0x02    // 请求全量：所有文件标记为脏后发送
+#define EEP_CMD_SYNC_ACK    0x03    // 确认：payload = [gen u16]
+#define EEP_CMD_STATUS_REQ  0x04    // 请求二进制状态
+#define EEP_CMD_TRACE_REQ   0x05    // 取出操作轨迹（EEFILE_TRACE=1）
+#define EEP_CMD_WCET_REQ    0x06    // 请求最坏执行时间（EEFILE_WCET=1）
+
+// ============ 设备 -> 主机 ============
+#define EEP_CMD_DELTA       0x81    // payload = [addr u16] + [数据...]
+#define EEP_CMD_SYNC_END    0x82    // payload = [gen u16] [帧数 u16] [镜像大小 u16]
+#define EEP_CMD_STATUS      0x83    // payload = 二进制状态（见下）
+#define EEP_CMD_TRACE       0x84    // payload = [丢弃数 u16] + 轨迹记录...
+#define EEP_CMD_WCET        0x85    // payload = [超限次数 u16] + EEP_OP_COUNT 个 [最大周期 u32]
+#define EEP_CMD_NAK         0xFF    // payload = [被拒绝的 cmd]
+
+// DELTA 帧中数据部分的最大长度（设备端栈上缓冲，保持较小）
+#define EEP_DELTA_CHUNK     32
+
+// ============ 二进制状态（EEP_CMD_STATUS 负载）============
+// 头部 44 字节（版本 1 为 28 字节，没有标记计数；版本 2 为 36 字节，没有最后三项）：
+//   [0]  magic u16      [2]  version u8     [3]  flags u8
+//   [4]  fileCount u8   [5]  maxFiles u8    [6]  totalSize u16   [8] usedSize u16
+//   [10] reads u32      [14] writes u32     [18] erases u32
+//   [22] bytesProgrammed u32                [26] errors u16
+//   [28] markerWrites u32                   [32] markerSkips u32
+//   [36] hashSkips u32  [40] verifyFailures u16                  [42] remaps u16
+// 有效位图：ceil(fileCount / 8) 字节，bit i 对应第 i 个注册的文件
+// 文件记录：每个 8 字节 [type u8][flags u8][startAddr u16][maxSize u16][dataLen u16]
+#define EEP_STATUS_MAGIC        0x5345      // "ES"
+#define EEP_STATUS_VERSION      3
+#define EEP_STATUS_HEADER_SIZE  44
+#define EEP_STATUS_HEADER_SIZE_V1   28
+#define EEP_STATUS_HEADER_SIZE_V2   36
+#define EEP_STATUS_FILE_SIZE    8
+#define EEP_STATUS_BITMAP_SIZE(n)   (((n) + 7) / 8)
+#define EEP_STATUS_SIZE(n)      (EEP_STATUS_HEADER_SIZE + EEP_STATUS_BITMAP_SIZE(n) + (n) * EEP_STATUS_FILE_SIZE)
+#define EEP_STATUS_MAX_SIZE     EEP_STATUS_SIZE(254)    // 状态帧不受 EEP_MAX_PAYLOAD 限制
+
+// flags 位
+#define EEP_STATUS_ENABLED      0x01
+#define EEP_STATUS_MODIFIED     0x02
+#define EEP_STATUS_VALID        0x04
+
+// ============ 操作轨迹记录（EEP_CMD_TRACE 负载）============
+// 每条 6 字节：[dt u16][op u8][type u8][len u16]
+//   dt   距上一条记录的毫秒数（饱和于 0xFFFF）
+//   op   低 7 位为操作码，bit7 = 操作失败
+//   len  请求的数据长度（read/write），其它操作为 0
+#define EEP_TRACE_RECORD_SIZE   6
+#define EEP_TRACE_PER_FRAME     ((EEP_MAX_PAYLOAD - 2) / EEP_TRACE_RECORD_SIZE)
+
+#define EEP_OP_READ             0x01
+#define EEP_OP_WRITE            0x02
+#define EEP_OP_ERASE            0x03
+#define EEP_OP_SET_VALID        0x04
+#define EEP_OP_SET_INVALID      0x05
+#define EEP_OP_IS_VALID         0x06
+#define EEP_OP_BEGIN            0x07
+#define EEP_OP_COUNT            8           // 以操作码为下标的表大小
+#define EEP_OP_FAILED           0x80
+
+// 最坏执行时间（EEP_CMD_WCET 负载）
+#define EEP_WCET_SIZE           (2 + EEP_OP_COUNT * 4)
+
+// ============ 存储策略编号（主机 ee_tune 推荐结果与设备端共用）============
+#define EEP_POLICY_WRITE_THROUGH    0       // 每次 write 直接编程
+#define EEP_POLICY_WRITE_BACK       1       // RAM 缓存，周期回写
+#define EEP_POLICY_AB_ATOMIC        2       // 两份副本交替写
+#define EEP_POLICY_LOG              3       // 区域内多槽位轮流追加
+#define EEP_POLICY_COUNTER          4       // 单调计数器，多槽位轮流写（仅设备端）
+#define EEP_POLICY_DEFAULTS         5       // 只读默认值，不占存储（仅设备端）
+#define EEP_POLICY_NONE             0xFF    // 未推荐（轨迹中未出现）
+
+// ============ CRC16-CCITT（与 EEFILE::calculateCRC 一致）============
+static inline uint16_t eep_crc16_update(uint16_t crc, uint8_t byte)
+{
+    crc ^= (uint16_t)byte << 8;
+    for (uint8_t b = 0; b < 8; b++) {
+        crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+static inline uint16_t eep_get_u16(const uint8_t* p)
+{
+    return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+static inline void eep_put_u16(uint8_t* p, uint16_t v)
+{
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline uint32_t eep_get_u32(const uint8_t* p)
+{
+    return (uint32_t)eep_get_u16(p) | ((uint32_t)eep_get_u16(p + 2) << 16);
+}
+
+static inline void eep_put_u32(uint8_t* p, uint32_t v)
+{
+    eep_put_u16(p, (uint16_t)(v & 0xFFFF));
+    eep_put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+/**
+ * 在 frame 中就地封装一帧：frame[EEP_HEADER_SIZE..] 已放好 len 字节负载，
+ * 填写帧头并在末尾追加 CRC，返回整帧长度
+ */
+static inline uint16_t eep_seal_frame(uint8_t* frame, uint8_t cmd, uint16_t len)
+{
+    frame[0] = EEP_SOF;
+    frame[1] = cmd;
+    eep_put_u16(frame + 2, len);
+    uint16_t crc = 0xFFFF;
+    for (uint16_t i = 1; i < EEP_HEADER_SIZE + len; i++) {
+        crc = eep_crc16_update(crc, frame[i]);
+    }
+    eep_put_u16(frame + EEP_HEADER_SIZE + len, crc);
+    return EEP_HEADER_SIZE + len + 2;
+}
+
+#endif
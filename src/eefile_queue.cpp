@@ -0,0 +1,123 @@
+/**
+ * @file eefile_queue.cpp
+ * @brief 持久化 FIFO 队列实现
+ */
+
+#include "eefile_queue.h"
+
+EEQueue::EEQueue(EEFileType type, uint16_t recSize, EEFILE& fs)
+    : EELog(type, recSize, 1, fs), headSeq(0), corrupt(0)
+{
+}
+
+// 标志不受 CRC 保护，位于槽的最后一个字节
+bool EEQueue::consumed(uint32_t seq)
+{
+    uint8_t flag = 0xFF;
+    fs.readAt(type, slotOf(seq) * slotSize() + slotSize() - 1, &flag, 1);
+    return flag != 0xFF;
+}
+
+// ============ 挂载：已取出的事件是顺序号上的一段前缀，二分查找队头 ============
+bool EEQueue::begin(void)
+{
+    headSeq = 0;
+    return EELog::begin();
+}
+
+void EEQueue::doMount(void)
+{
+    EELog::doMount();
+    uint32_t lo = oldestSeq();
+    uint32_t hi = seqNext;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        probes++;
+        if (consumed(mid)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    headSeq = lo;
+    FILE_DEBUG("[EEQUEUE] Type %d: %d pending (head seq %lu)", type, size(), (unsigned long)headSeq);
+}
+
+// ============ 入队 / 出队 ============
+bool EEQueue::push(const void* rec)
+{
+    if (isFull()) {
+        FILE_DEBUG("[EEQUEUE] ERROR: Type %d full", type);
+        return false;
+    }
+    return append(rec);
+}
+
+// 队头损坏时写标志取出它：已取出的事件仍是顺序号上的前缀，下次挂载不再看到
+bool EEQueue::peek(void* rec, uint32_t* seq)
+{
+    while (!isEmpty()) {
+        if (peekAt(0, rec, seq)) {
+            return true;
+        }
+        FILE_DEBUG("[EEQUEUE] WARNING: Type %d event %lu corrupt, dropped",
+            type, (unsigned long)headSeq);
+        if (!pop()) {
+            return false;
+        }
+        corrupt++;
+    }
+    return false;
+}
+
+bool EEQueue::peekAt(uint16_t n, void* rec, uint32_t* seq)
+{
+    if (n >= size()) {
+        return false;
+    }
+    if (seq) {
+        *seq = headSeq + n;
+    }
+    return readSeq(headSeq + n, rec);
+}
+
+bool EEQueue::pop(void)
+{
+    if (isEmpty()) {
+        return false;
+    }
+    uint8_t flag = EEQUEUE_CONSUMED;
+    if (!fs.writeAt(type, slotOf(headSeq) * slotSize() + slotSize() - 1, &flag, 1)) {
+        return false;
+    }
+    headSeq++;
+    return true;
+}
+
+void EEQueue::clear(void)
+{
+    EELog::clear();
+    headSeq = 0;
+}
+
+// ============ 查询 ============
+uint16_t EEQueue::size(void) const
+{
+    ensureMounted();
+    return seqNext - headSeq;
+}
+
+bool EEQueue::isEmpty(void) const
+{
+    return size() == 0;
+}
+
+bool EEQueue::isFull(void) const
+{
+    return slots == 0 || size() >= slots;
+}
+
+uint16_t EEQueue::getCorruptCount(void) const
+{
+    return corrupt;
+}
@@ -0,0 +1,83 @@
+/**
+ * @file eefile_queue.h
+ * @brief 持久化 FIFO 队列：离线时缓存待发送事件，上电后继续发送
+ *
+ * 在环形日志（eefile_log.h）的每个槽后附加 1 字节“已取出”标志：
+ *   [顺序号 u32][事件数据][CRC16][标志]
+ * 没有单独的头/尾指针字节：
+ *   - 尾（最新事件）由顺序号确定，与环形日志相同
+ *   - 头（最旧未取出事件）：已取出的事件在顺序号上是一段前缀，
+ *     begin() 对标志做二分查找
+ *   - pop() 只把头部事件的标志写为 0x00，O(1)，磨损分散到所有槽
+ * 队列满时 push() 失败，不覆盖未取出的事件。
+ * 队头事件 CRC 不符（写入中掉电等）时 peek() 把它标记为已取出并计数，
+ * 与环形日志挂载时把撕裂的记录当作空槽一致，队列不会卡在一条坏记录上。
+ *
+ * 用法：
+ *   EE_REG(EVENTS, EEQUEUE_SIZE(sizeof(Event), 32));
+ *   EEQueue events(EVENTS, sizeof(Event));
+ *   events.begin();
+ *   events.push(&e);
+ *   while (events.peek(&e) && send(e)) events.pop();
+ */
+
+#ifndef __EEFILE_QUEUE__
+#define __EEFILE_QUEUE__
+
+#include "eefile_log.h"
+
+#define EEQUEUE_CONSUMED 0x00
+
+// 队列文件注册大小：recSize 字节的事件最多 count 条
+#define EEQUEUE_SIZE(recSize, count) ((uint16_t)(((recSize) + EELOG_OVERHEAD + 1) * (count)))
+
+class EEQueue : protected EELog
+{
+  public:
+    EEQueue(EEFileType type, uint16_t recSize, EEFILE& fs = EEFILE::getInstance());
+
+    /**
+     * @brief 挂载：找到最新事件和第一个未取出的事件
+     */
+    bool begin(void);
+
+    /**
+     * @brief 入队，队列满时返回 false
+     */
+    bool push(const void* rec);
+
+    /**
+     * @brief 读取队头事件（不出队），跳过并取出 CRC 不符的队头事件
+     * @param seq 可选，返回该事件的顺序号
+     */
+    bool peek(void* rec, uint32_t* seq = NULL);
+
+    /**
+     * @brief 队头事件出队（只写 1 字节标志）
+     */
+    bool pop(void);
+
+    /**
+     * @brief 读取队头之后第 n 个事件（0 为队头）
+     */
+    bool peekAt(uint16_t n, void* rec, uint32_t* seq = NULL);
+
+    uint16_t size(void) const;          // 未取出的事件数
+    uint16_t getCorruptCount(void) const;   // peek() 跳过的损坏事件数
+    bool isEmpty(void) const;
+    bool isFull(void) const;
+    void clear(void);                   // 丢弃所有事件
+    using EELog::capacity;
+    using EELog::getMountProbes;
+    using EELog::mount;
+    using EELog::isMounted;
+
+  private:
+    uint32_t headSeq;                   // 第一个未取出事件的顺序号
+    uint16_t corrupt;
+
+    void doMount(void);
+    bool consumed(uint32_t seq);
+};
+
+#endif
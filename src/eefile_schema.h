@@ -0,0 +1,167 @@
+/**
+ * @file eefile_schema.h
+ * @brief 编译期位打包模式：按字段位宽把结构体压缩成最少的字节再存储
+ *
+ * 直接 EE_WRITE 结构体会把编译器的填充字节和每个字段的全部宽度都写进去。
+ * 用模板声明每个字段的位宽后，pack()/unpack() 按位顺序（LSB 优先、小端）
+ * 逐位拼接，与 CPU 字节序、对齐方式无关，AVR / ARM / ESP 之间可以互读。
+ *
+ *   struct Config {
+ *       uint8_t mode;          // 0..7
+ *       bool enabled;
+ *       int16_t adcOffset;     // -512..511
+ *   };
+ *   typedef EESchema<Config,
+ *       EE_FIELD(Config, mode, 3),
+ *       EE_FIELD(Config, enabled, 1),
+ *       EE_FIELD(Config, adcOffset, 10)> ConfigSchema;     // 14 位 -> 2 字节
+ *
+ *   EE_REG_SCHEMA(CONFIG, ConfigSchema);
+ *   EE_WRITE_SCHEMA(ConfigSchema, CONFIG, cfg);
+ *   EE_READ_SCHEMA(ConfigSchema, CONFIG, cfg);
+ *
+ * 字段类型可以是整数、bool 或枚举，位宽 1..32；有符号类型读出时做符号扩展。
+ * 超出位宽的值被截断（只保留低位）。
+ */
+
+#ifndef __EEFILE_SCHEMA__
+#define __EEFILE_SCHEMA__
+
+#include "eefile.h"
+
+// ============ 位读写：第 pos 位起 bits 位，LSB 优先 ============
+static inline void eeschema_put(uint8_t* buf, uint16_t pos, uint8_t bits, uint32_t v)
+{
+    for (uint8_t i = 0; i < bits; i++, pos++) {
+        uint8_t mask = 1 << (pos & 7);
+        if ((v >> i) & 1) {
+            buf[pos >> 3] |= mask;
+        } else {
+            buf[pos >> 3] &= ~mask;
+        }
+    }
+}
+
+static inline uint32_t eeschema_get(const uint8_t* buf, uint16_t pos, uint8_t bits)
+{
+    uint32_t v = 0;
+    for (uint8_t i = 0; i < bits; i++, pos++) {
+        v |= (uint32_t)((buf[pos >> 3] >> (pos & 7)) & 1) << i;
+    }
+    return v;
+}
+
+// ============ 有符号类型判断（不依赖 <type_traits>，AVR 上没有）============
+template <typename T> struct EESchemaSigned { static const bool value = false; };
+template <> struct EESchemaSigned<signed char> { static const bool value = true; };
+template <> struct EESchemaSigned<short> { static const bool value = true; };
+template <> struct EESchemaSigned<int> { static const bool value = true; };
+template <> struct EESchemaSigned<long> { static const bool value = true; };
+template <> struct EESchemaSigned<long long> { static const bool value = true; };
+template <> struct EESchemaSigned<char> { static const bool value = (char)-1 < 0; };  // 由平台决定
+
+// ============ 字段 ============
+template <typename S, typename T, T S::*Member, uint8_t Bits>
+struct EEField
+{
+    static_assert(Bits >= 1 && Bits <= 32, "EE_FIELD width must be 1..32 bits");
+    static const uint8_t BITS = Bits;
+
+    static uint32_t get(const S& s)
+    {
+        return (uint32_t)(s.*Member);
+    }
+
+    static void set(S& s, uint32_t v)
+    {
+        if (!EESchemaSigned<T>::value) {
+            s.*Member = (T)v;
+            return;
+        }
+        if (Bits < 32 && ((v >> (Bits - 1)) & 1)) {
+            v |= ~(uint32_t)0 << Bits;              // 符号扩展到 32 位
+        }
+        s.*Member = (T)(int32_t)v;                  // 再按 int32_t 扩展到更宽的类型（long long）
+    }
+};
+
+// 声明字段：结构体、成员名、位宽
+#define EE_FIELD(S, member, bits) EEField<S, decltype(S::member), &S::member, bits>
+
+// ============ 逐字段递归打包 ============
+template <typename S, uint16_t Pos, typename... Fields>
+struct EESchemaFields
+{
+    static const uint16_t BITS = 0;
+    static void pack(const S&, uint8_t*) {}
+    static void unpack(S&, const uint8_t*) {}
+};
+
+template <typename S, uint16_t Pos, typename F, typename... Rest>
+struct EESchemaFields<S, Pos, F, Rest...>
+{
+    typedef EESchemaFields<S, Pos + F::BITS, Rest...> Next;
+    static const uint16_t BITS = F::BITS + Next::BITS;
+
+    static void pack(const S& s, uint8_t* buf)
+    {
+        eeschema_put(buf, Pos, F::BITS, F::get(s));
+        Next::pack(s, buf);
+    }
+
+    static void unpack(S& s, const uint8_t* buf)
+    {
+        F::set(s, eeschema_get(buf, Pos, F::BITS));
+        Next::unpack(s, buf);
+    }
+};
+
+// ============ 模式 ============
+template <typename S, typename... Fields>
+struct EESchema
+{
+    typedef EESchemaFields<S, 0, Fields...> List;
+    static const uint16_t BITS = List::BITS;
+    static const uint16_t BYTES = (BITS + 7) / 8;  // 存储字节数
+
+    /**
+     * @brief 打包到 buf（BYTES 字节，末字节未用的高位为 0）
+     */
+    static void pack(const S& s, uint8_t* buf)
+    {
+        buf[BYTES - 1] = 0;
+        List::pack(s, buf);
+    }
+
+    /**
+     * @brief 从 buf 解包，未列入模式的成员保持不变
+     */
+    static void unpack(S& s, const uint8_t* buf)
+    {
+        List::unpack(s, buf);
+    }
+
+    static bool write(EEFileType type, const S& s, EEFILE& fs = EEFILE::getInstance())
+    {
+        uint8_t buf[BYTES];
+        pack(s, buf);
+        return fs.write(type, buf, BYTES);
+    }
+
+    static bool read(EEFileType type, S& s, EEFILE& fs = EEFILE::getInstance())
+    {
+        uint8_t buf[BYTES];
+        if (!fs.read(type, buf, BYTES)) {
+            return false;
+        }
+        unpack(s, buf);
+        return true;
+    }
+};
+
+// ============ 便捷宏 ============
+#define EE_REG_SCHEMA(type, Schema) EE.registerAuto(type, Schema::BYTES)
+#define EE_WRITE_SCHEMA(Schema, type, obj) Schema::write(type, obj)
+#define EE_READ_SCHEMA(Schema, type, obj) Schema::read(type, obj)
+
+#endif
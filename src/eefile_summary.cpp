@@ -0,0 +1,173 @@
+/**
+ * @file eefile_summary.cpp
+ * @brief 带块摘要的环形日志实现
+ */
+
+#include "eefile_summary.h"
+
+EESummaryLog::EESummaryLog(EEFileType type, uint16_t recSize, EEFileType summaryType,
+    uint16_t blockSize, EELogValueFn value, uint8_t* recBuf, EEFILE& fs)
+    : EELog(type, recSize, fs), summaryType(summaryType),
+      blockSize(blockSize), value(value), recBuf(recBuf),
+      summaryReads(0), recordReads(0)
+{
+    memset(&running, 0, sizeof(running));
+}
+
+// ============ 统计合并 ============
+void EESummaryLog::add(EELogAggregate* a, int32_t v)
+{
+    if (a->count == 0 || v < a->min) {
+        a->min = v;
+    }
+    if (a->count == 0 || v > a->max) {
+        a->max = v;
+    }
+    a->sum += v;
+    a->count++;
+}
+
+void EESummaryLog::merge(EELogAggregate* a, const EELogAggregate& b)
+{
+    if (b.count == 0) {
+        return;
+    }
+    if (a->count == 0 || b.min < a->min) {
+        a->min = b.min;
+    }
+    if (a->count == 0 || b.max > a->max) {
+        a->max = b.max;
+    }
+    a->sum += b.sum;
+    a->count += b.count;
+}
+
+// ============ 挂载：检查块划分，挂载时重建当前未写满块的统计 ============
+bool EESummaryLog::begin(void)
+{
+    uint16_t cap = fs.getFileMaxSize(type) / slotSize();
+    memset(&running, 0, sizeof(running));
+    if (blockSize == 0 || cap % blockSize != 0 ||
+        fs.getFileMaxSize(summaryType) < EESUMMARY_SIZE(cap, blockSize)) {
+        FILE_DEBUG("[EESUM] ERROR: log of %d records cannot use blocks of %d", cap, blockSize);
+        return false;
+    }
+    return EELog::begin();
+}
+
+void EESummaryLog::doMount(void)
+{
+    EELog::doMount();
+    if (count() > 0 && (newestSeq() + 1) % blockSize != 0) {
+        for (uint32_t s = newestSeq() - newestSeq() % blockSize; s <= newestSeq(); s++) {
+            if (s >= oldestSeq() && readSeq(s, recBuf)) {
+                add(&running, value(recBuf));
+            }
+        }
+    }
+}
+
+// ============ 摘要记录 ============
+static uint16_t summaryCrc(const uint8_t* b)
+{
+    uint16_t crc = 0xFFFF;
+    for (uint8_t i = 0; i < EESUMMARY_RECORD - 2; i++) {
+        crc = eep_crc16_update(crc, b[i]);
+    }
+    return crc;
+}
+
+bool EESummaryLog::readSummary(uint32_t blockSeq, EELogAggregate* a)
+{
+    uint8_t b[EESUMMARY_RECORD];
+    uint16_t off = (blockSeq % capacity()) / blockSize * EESUMMARY_RECORD;
+    summaryReads++;
+    if (!fs.readAt(summaryType, off, b, sizeof(b)) ||
+        eep_get_u16(b + 22) != summaryCrc(b) ||
+        eep_get_u32(b) != blockSeq) {
+        return false;
+    }
+    a->count = eep_get_u16(b + 4);
+    a->min = (int32_t)eep_get_u32(b + 6);
+    a->max = (int32_t)eep_get_u32(b + 10);
+    // 总和按 8 字节保存：一块内的 i32 之和可以超出 ±2^31
+    a->sum = (int64_t)(((uint64_t)eep_get_u32(b + 18) << 32) | eep_get_u32(b + 14));
+    return true;
+}
+
+void EESummaryLog::writeSummary(uint32_t blockSeq)
+{
+    uint8_t b[EESUMMARY_RECORD];
+    uint16_t off = (blockSeq % capacity()) / blockSize * EESUMMARY_RECORD;
+    eep_put_u32(b, blockSeq);
+    eep_put_u16(b + 4, (uint16_t)running.count);
+    eep_put_u32(b + 6, (uint32_t)running.min);
+    eep_put_u32(b + 10, (uint32_t)running.max);
+    eep_put_u32(b + 14, (uint32_t)running.sum);
+    eep_put_u32(b + 18, (uint32_t)((uint64_t)running.sum >> 32));
+    eep_put_u16(b + 22, summaryCrc(b));
+    fs.writeAt(summaryType, off, b, sizeof(b));
+}
+
+// ============ 追加：块写满时写入摘要 ============
+bool EESummaryLog::append(const void* rec)
+{
+    if (!EELog::append(rec)) {
+        return false;
+    }
+    uint32_t seq = newestSeq();
+    add(&running, value(rec));
+    if ((seq + 1) % blockSize == 0) {
+        writeSummary(seq + 1 - blockSize);
+        memset(&running, 0, sizeof(running));
+    }
+    return true;
+}
+
+// ============ 区间统计 ============
+bool EESummaryLog::aggregate(uint32_t fromSeq, uint32_t toSeq, EELogAggregate* out)
+{
+    memset(out, 0, sizeof(*out));
+    summaryReads = 0;
+    recordReads = 0;
+    if (count() == 0) {
+        return false;
+    }
+    if (fromSeq < oldestSeq()) {
+        fromSeq = oldestSeq();
+    }
+    if (toSeq > newestSeq()) {
+        toSeq = newestSeq();
+    }
+
+    uint32_t s = fromSeq;
+    while (s <= toSeq) {
+        // 完整落在区间内的块：用摘要
+        EELogAggregate blk;
+        if (s % blockSize == 0 && toSeq - s >= (uint32_t)blockSize - 1 &&
+            readSummary(s, &blk)) {
+            merge(out, blk);
+            s += blockSize;
+            continue;
+        }
+        recordReads++;
+        if (readSeq(s, recBuf)) {
+            add(out, value(recBuf));
+        }
+        if (s == toSeq) {
+            break;
+        }
+        s++;
+    }
+    return out->count > 0;
+}
+
+uint16_t EESummaryLog::getSummaryReads() const
+{
+    return summaryReads;
+}
+
+uint16_t EESummaryLog::getRecordReads() const
+{
+    return recordReads;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file eefile_summary.h
+ * @brief 带块摘要的环形日志：区间统计只读摘要和两端的零散记录
+ *
+ * 日志按顺序号每 blockSize 条分为一块，块写满时把该块的
+ * [首条顺序号 u32][条数 u16][最小 i32][最大 i32][总和 i64][CRC16]
+ * 写入单独的摘要文件（每块一条，与日志槽一一对应，同样循环覆盖）。
+ * aggregate(from, to) 对完整落在区间内、摘要有效的块直接合并摘要，
+ * 只有区间两端不完整的块和当前未写满的块才逐条读取记录。
+ * 摘要的首条顺序号与块不符（该块已被新一圈覆盖）时按零散记录处理。
+ *
+ * 用法：
+ *   EE_REG(SAMPLES, EELOG_SIZE(sizeof(Sample), 256));
+ *   EE_REG(SAMPLE_SUM, EESUMMARY_SIZE(256, 16));
+ *   EESUMMARY_LOG(samples, SAMPLES, Sample, SAMPLE_SUM, 16, sampleValue);
+ */
+
+#ifndef __EEFILE_SUMMARY__
+#define __EEFILE_SUMMARY__
+
+#include "eefile_log.h"
+
+#define EESUMMARY_RECORD 24
+
+// 摘要文件注册大小：日志 slots 条、每块 block 条（slots 须为 block 的整数倍）
+#define EESUMMARY_SIZE(slots, block) ((uint16_t)((slots) / (block) * EESUMMARY_RECORD))
+
+// 从一条记录中取出参与统计的数值
+typedef int32_t (*EELogValueFn)(const void* rec);
+
+typedef struct {
+    uint32_t count;
+    int32_t min;
+    int32_t max;
+    int64_t sum;
+} EELogAggregate;
+
+class EESummaryLog : public EELog
+{
+  public:
+    /**
+     * @param type 日志文件，大小用 EELOG_SIZE()
+     * @param recSize 每条记录的用户数据字节数
+     * @param summaryType 摘要文件，大小用 EESUMMARY_SIZE()
+     * @param blockSize 每块记录条数，日志容量须为其整数倍
+     * @param value 取值函数
+     * @param recBuf 记录缓冲，至少 recSize 字节（统计时逐条读取记录用）
+     */
+    EESummaryLog(EEFileType type, uint16_t recSize, EEFileType summaryType,
+        uint16_t blockSize, EELogValueFn value, uint8_t* recBuf,
+        EEFILE& fs = EEFILE::getInstance());
+
+    /**
+     * @brief 挂载日志，并从记录重建当前未写满块的统计
+     */
+    bool begin(void);
+
+    /**
+     * @brief 追加一条记录，块写满时写入该块摘要
+     */
+    bool append(const void* rec);
+
+    /**
+     * @brief 统计顺序号 [fromSeq, toSeq] 内（与现存记录取交集）的记录
+     * @return 区间内至少有一条记录
+     */
+    bool aggregate(uint32_t fromSeq, uint32_t toSeq, EELogAggregate* out);
+
+    uint16_t getSummaryReads() const;   // 上一次 aggregate() 读取的摘要数
+    uint16_t getRecordReads() const;    // 上一次 aggregate() 读取的记录数
+
+  private:
+    EEFileType summaryType;
+    uint16_t blockSize;
+    EELogValueFn value;
+    uint8_t* recBuf;
+    EELogAggregate running;             // 当前未写满块的统计
+    uint16_t summaryReads;
+    uint16_t recordReads;
+
+    void doMount(void);
+    void add(EELogAggregate* a, int32_t v);
+    void merge(EELogAggregate* a, const EELogAggregate& b);
+    bool readSummary(uint32_t blockSeq, EELogAggregate* a);
+    void writeSummary(uint32_t blockSeq);
+};
+
+// 定义一个带记录缓冲的摘要日志实例
+#define EESUMMARY_LOG(name, type, Rec, summaryType, block, valueFn) \
+    static uint8_t name##_rec[sizeof(Rec)];                         \
+    EESummaryLog name(type, sizeof(Rec), summaryType, block, valueFn, name##_rec)
+
+#endif
@@ -0,0 +1,247 @@
+/**
+ * @file eefile_sync.cpp
+ * @brief 增量备份协议实现：只发送脏区间，主机确认后才清除
+ */
+
+#include "eefile_sync.h"
+
+#if EEFILE_SYNC
+
+enum {
+    RX_SOF = 0,
+    RX_CMD,
+    RX_LEN_LO,
+    RX_LEN_HI,
+    RX_PAYLOAD,
+    RX_CRC_LO,
+    RX_CRC_HI
+};
+
+EESync::EESync(Stream &stream, EEFILE &eefile)
+    : io(stream), fs(eefile),
+      rxState(RX_SOF), rxCmd(0), rxLen(0), rxPos(0), rxCrc(0),
+      sending(false), awaitingAck(false),
+      curFile(0), curAddr(0), frames(0), gen(0)
+{
+}
+
+// ============ 主循环 ============
+void EESync::poll(void)
+{
+    while (io.available() > 0) {
+        uint8_t c = (uint8_t)io.read();
+
+        switch (rxState) {
+        case RX_SOF:
+            if (c == EEP_SOF) {
+                rxCrc = 0xFFFF;
+                rxState = RX_CMD;
+            }
+            break;
+        case RX_CMD:
+            rxCmd = c;
+            rxCrc = eep_crc16_update(rxCrc, c);
+            rxState = RX_LEN_LO;
+            break;
+        case RX_LEN_LO:
+            rxLen = c;
+            rxCrc = eep_crc16_update(rxCrc, c);
+            rxState = RX_LEN_HI;
+            break;
+        case RX_LEN_HI:
+            rxLen |= (uint16_t)c << 8;
+            rxCrc = eep_crc16_update(rxCrc, c);
+            rxPos = 0;
+            if (rxLen > sizeof(rxBuf)) {
+                rxState = RX_SOF;           // 非法长度，丢弃
+            } else {
+                rxState = rxLen ? RX_PAYLOAD : RX_CRC_LO;
+            }
+            break;
+        case RX_PAYLOAD:
+            rxBuf[rxPos++] = c;
+            rxCrc = eep_crc16_update(rxCrc, c);
+            if (rxPos >= rxLen) {
+                rxState = RX_CRC_LO;
+            }
+            break;
+        case RX_CRC_LO:
+            rxCrc ^= c;                     // 低字节先比对
+            rxState = RX_CRC_HI;
+            break;
+        case RX_CRC_HI:
+            rxCrc ^= (uint16_t)c << 8;
+            rxState = RX_SOF;
+            if (rxCrc == 0) {
+                handleCommand();
+            } else {
+                FILE_DEBUG("[EESYNC] CRC error, cmd 0x%02X dropped", rxCmd);
+            }
+            break;
+        }
+    }
+
+    if (sending) {
+        sendNext();
+    }
+}
+
+// ============ 处理主机命令 ============
+void EESync::handleCommand(void)
+{
+    switch (rxCmd) {
+    case EEP_CMD_SYNC_REQ:
+        startBatch(false);
+        break;
+    case EEP_CMD_SYNC_FULL:
+        startBatch(true);
+        break;
+    case EEP_CMD_STATUS_REQ:
+        fs.printStatusBinary(io);
+        break;
+#if EEFILE_TRACE
+    case EEP_CMD_TRACE_REQ:
+        fs.printTraceBinary(io);
+        break;
+#endif
+#if EEFILE_WCET
+    case EEP_CMD_WCET_REQ:
+        fs.printWcetBinary(io);
+        break;
+#endif
+    case EEP_CMD_SYNC_ACK:
+        if (awaitingAck && rxLen == 2 && eep_get_u16(rxBuf) == gen) {
+            commitBatch();
+        } else {
+            sendFrame(EEP_CMD_NAK, &rxCmd, 1);
+        }
+        break;
+    default:
+        sendFrame(EEP_CMD_NAK, &rxCmd, 1);
+        break;
+    }
+}
+
+// ============ 开始新一批：脏区间 -> 发送区间 ============
+void EESync::startBatch(bool full)
+{
+    // 上一批没有确认：把已发送区间合并回脏区间，保证不丢数据
+    rollbackBatch();
+
+    for (uint8_t i = 0; i < fs.syncRangeCount(); i++) {
+        EESyncRange &r = *fs.syncRange(i);
+        if (full) {
+#if EEFILE_VALID_BITMAP
+            if (&r == &fs.vbmSync) {
+                r.lo = EEFILE::VBM_ADDR;
+                r.hi = EEFILE::TOTAL_SIZE - 1;
+            } else
+#endif
+#if EEFILE_VERIFY
+            if (&r == &fs.remapSync) {
+                r.lo = EEFILE::SPARE_ADDR;
+                r.hi = EEFILE::AREA_END - 1;
+            } else
+#endif
+            {
+                r.lo = fs.files[i].startAddr;
+                r.hi = fs.files[i].endAddr;
+            }
+        }
+        r.sentLo = r.lo;
+        r.sentHi = r.hi;
+        r.lo = 0xFFFF;
+        r.hi = 0;
+    }
+
+    gen++;
+    curFile = 0;
+    curAddr = fs.syncRangeCount() ? fs.syncRange(0)->sentLo : 0;
+    frames = 0;
+    sending = true;
+    awaitingAck = false;
+
+    FILE_DEBUG("[EESYNC] Batch %u started (%s)", gen, full ? "full" : "delta");
+}
+
+void EESync::rollbackBatch(void)
+{
+    for (uint8_t i = 0; i < fs.syncRangeCount(); i++) {
+        EESyncRange &r = *fs.syncRange(i);
+        if (r.sentLo > r.sentHi) {
+            continue;
+        }
+        if (r.lo > r.hi) {
+            r.lo = r.sentLo;
+            r.hi = r.sentHi;
+        } else {
+            if (r.sentLo < r.lo) r.lo = r.sentLo;
+            if (r.sentHi > r.hi) r.hi = r.sentHi;
+        }
+        r.sentLo = 0xFFFF;
+        r.sentHi = 0;
+    }
+    awaitingAck = false;
+}
+
+void EESync::commitBatch(void)
+{
+    for (uint8_t i = 0; i < fs.syncRangeCount(); i++) {
+        fs.syncRange(i)->sentLo = 0xFFFF;
+        fs.syncRange(i)->sentHi = 0;
+    }
+    awaitingAck = false;
+    FILE_DEBUG("[EESYNC] Batch %u acknowledged", gen);
+}
+
+// ============ 每次调用发送一帧 DELTA，全部发完后发送 END ============
+void EESync::sendNext(void)
+{
+    while (curFile < fs.syncRangeCount()) {
+        EESyncRange &r = *fs.syncRange(curFile);
+        if (r.sentLo <= r.sentHi && curAddr <= r.sentHi) {
+            if (curAddr < r.sentLo) {
+                curAddr = r.sentLo;
+            }
+            uint16_t n = r.sentHi - curAddr + 1;
+            if (n > EEP_DELTA_CHUNK) {
+                n = EEP_DELTA_CHUNK;
+            }
+
+            uint8_t payload[2 + EEP_DELTA_CHUNK];
+            eep_put_u16(payload, curAddr);
+            fs.ioReadBlock(curAddr, payload + 2, n);
+            sendFrame(EEP_CMD_DELTA, payload, n + 2);
+
+            curAddr += n;
+            frames++;
+            return;
+        }
+
+        // 下一个文件（位图模式下最后是位图槽区域）
+        curFile++;
+        curAddr = (curFile < fs.syncRangeCount()) ? fs.syncRange(curFile)->sentLo : 0;
+    }
+
+    uint8_t payload[6];
+    eep_put_u16(payload, gen);
+    eep_put_u16(payload + 2, frames);
+    eep_put_u16(payload + 4, EEFILE::TOTAL_SIZE);
+    sendFrame(EEP_CMD_SYNC_END, payload, sizeof(payload));
+
+    sending = false;
+    awaitingAck = true;
+    FILE_DEBUG("[EESYNC] Batch %u sent (%u frames)", gen, frames);
+}
+
+void EESync::sendFrame(uint8_t cmd, const uint8_t* payload, uint16_t len)
+{
+    uint8_t frame[EEP_HEADER_SIZE + 2 + EEP_DELTA_CHUNK + 2];
+    if (len > sizeof(frame) - EEP_HEADER_SIZE - 2) {
+        return;
+    }
+    memcpy(frame + EEP_HEADER_SIZE, payload, len);
+    io.write(frame, eep_seal_frame(frame, cmd, len));
+}
+
+#endif
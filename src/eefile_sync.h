@@ -0,0 +1,62 @@
+/**
+ * @file eefile_sync.h
+ * @brief 基于脏区间的增量备份协议（设备端）
+ * @note 需要在编译选项中定义 EEFILE_SYNC=1，帧格式见 eefile_proto.h
+ *
+ * 工作流程：
+ *   1. 主机发送 SYNC_REQ（或首次使用 SYNC_FULL）
+ *   2. 设备在 poll() 中逐帧发送自上次确认以来变化的字节区间（DELTA）
+ *   3. 设备发送 SYNC_END(gen)，主机落盘后回复 SYNC_ACK(gen)
+ *   4. 未收到确认就再次请求时，上一批区间会合并回来重新发送
+ */
+
+#ifndef __EEFILE_SYNC__
+#define __EEFILE_SYNC__
+#include "eefile.h"
+#include "eefile_proto.h"
+
+#if EEFILE_SYNC
+
+class EESync
+{
+  private:
+    Stream &io;
+    EEFILE &fs;
+
+    // 接收状态机
+    uint8_t rxState;
+    uint8_t rxCmd;
+    uint16_t rxLen;
+    uint16_t rxPos;
+    uint16_t rxCrc;
+    uint8_t rxBuf[8];                      // 主机命令负载很短
+
+    // 发送状态
+    bool sending;                          // 正在逐帧发送本批增量
+    bool awaitingAck;                      // 本批已发完，等待主机确认
+    uint8_t curFile;
+    uint16_t curAddr;
+    uint16_t frames;
+    uint16_t gen;                          // 批次号，每次请求 +1
+
+    void handleCommand(void);
+    void startBatch(bool full);
+    void rollbackBatch(void);
+    void commitBatch(void);
+    void sendNext(void);
+    void sendFrame(uint8_t cmd, const uint8_t* payload, uint16_t len);
+
+  public:
+    EESync(Stream &stream, EEFILE &eefile = EEFILE::getInstance());
+
+    /**
+     * @brief 在 loop() 中周期调用：解析主机命令，每次最多发送一帧
+     */
+    void poll(void);
+
+    bool isBusy() const { return sending; }
+    uint16_t generation() const { return gen; }
+};
+
+#endif
+#endif
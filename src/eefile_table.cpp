@@ -0,0 +1,205 @@
+/**
+ * @file eefile_table.cpp
+ * @brief 有序查找表文件类型实现
+ */
+
+#include "eefile_table.h"
+
+EETable::EETable(EEFileType type, uint8_t width, EEFILE& fs)
+    : fs(fs), type(type), width((width == 2) ? 2 : 4), entries(0), writing(false),
+      hint(0), cacheNext(0), deviceReads(0), cacheHits(0)
+{
+    invalidate();
+}
+
+void EETable::invalidate(void)
+{
+    for (uint8_t i = 0; i < EETABLE_CACHE_PAGES; i++) {
+        cachePage[i] = 0xFFFF;
+    }
+}
+
+bool EETable::begin(void)
+{
+    uint8_t b[2];
+    invalidate();
+    entries = 0;
+    writing = false;
+    hint = 0;
+    if (!fs.isFileValid(type) || !fs.readAt(type, 0, b, sizeof(b))) {
+        return false;
+    }
+    entries = eep_get_u16(b);
+    if (entries > capacity()) {
+        FILE_DEBUG("[EETABLE] ERROR: Type %d count %d > capacity %d", type, entries, capacity());
+        entries = 0;
+    }
+    return entries > 0;
+}
+
+// ============ 页缓存 ============
+uint8_t EETable::byteAt(uint16_t off)
+{
+    uint16_t page = off / EETABLE_PAGE_SIZE;
+    uint8_t slot = 0;
+    while (slot < EETABLE_CACHE_PAGES && cachePage[slot] != page) {
+        slot++;
+    }
+    if (slot < EETABLE_CACHE_PAGES) {
+        cacheHits++;
+    } else {
+        uint16_t start = page * EETABLE_PAGE_SIZE;
+        uint16_t n = fs.getFileMaxSize(type) - start;
+        if (n > EETABLE_PAGE_SIZE) {
+            n = EETABLE_PAGE_SIZE;
+        }
+        slot = cacheNext;
+        cacheNext = (cacheNext + 1) % EETABLE_CACHE_PAGES;
+        fs.readAt(type, start, cache[slot], n);
+        cachePage[slot] = page;
+        deviceReads++;
+    }
+    return cache[slot][off % EETABLE_PAGE_SIZE];
+}
+
+// 小端有符号整数，2 字节时符号扩展
+int32_t EETable::intAt(uint16_t off)
+{
+    uint32_t v = 0;
+    for (uint8_t i = 0; i < width; i++) {
+        v |= (uint32_t)byteAt(off + i) << (8 * i);
+    }
+    return (width == 2) ? (int32_t)(int16_t)v : (int32_t)v;
+}
+
+int32_t EETable::keyAt(uint16_t i)
+{
+    return intAt(2 + i * 2 * width);
+}
+
+int32_t EETable::valueAt(uint16_t i)
+{
+    return intAt(2 + i * 2 * width + width);
+}
+
+// 条目 i 是否为第一个键 >= key 的条目（i == entries 表示 key 大于所有键）
+bool EETable::brackets(uint16_t i, int32_t key)
+{
+    return (i == entries || keyAt(i) >= key) && (i == 0 || keyAt(i - 1) < key);
+}
+
+// ============ 查找：第一个键 >= key 的条目 ============
+bool EETable::lookup(int32_t key, int32_t* value, bool interpolate)
+{
+    if (entries == 0) {
+        return false;
+    }
+    uint16_t lo;
+    if (hint <= entries && brackets(hint, key)) {
+        lo = hint;
+    } else if (hint < entries && brackets(hint + 1, key)) {
+        lo = hint + 1;
+    } else if (hint > 0 && hint <= entries && brackets(hint - 1, key)) {
+        lo = hint - 1;
+    } else {
+        lo = 0;
+        uint16_t hi = entries;
+        while (lo < hi) {
+            uint16_t mid = lo + (hi - lo) / 2;
+            if (keyAt(mid) < key) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+    }
+    hint = lo;
+
+    if (lo < entries && keyAt(lo) == key) {
+        *value = valueAt(lo);
+        return true;
+    }
+    if (!interpolate) {
+        return false;
+    }
+    if (lo == 0) {
+        *value = valueAt(0);
+    } else if (lo == entries) {
+        *value = valueAt(entries - 1);
+    } else {
+        int32_t x0 = keyAt(lo - 1);
+        int32_t x1 = keyAt(lo);
+        int32_t y0 = valueAt(lo - 1);
+        int32_t y1 = valueAt(lo);
+        *value = y0 + (int32_t)(((int64_t)y1 - y0) * ((int64_t)key - x0) / ((int64_t)x1 - x0));
+    }
+    return true;
+}
+
+bool EETable::entry(uint16_t i, int32_t* key, int32_t* value)
+{
+    if (i >= entries) {
+        return false;
+    }
+    *key = keyAt(i);
+    *value = valueAt(i);
+    return true;
+}
+
+// ============ 写表 ============
+bool EETable::put(uint16_t i, int32_t key, int32_t value)
+{
+    if (i >= capacity()) {
+        return false;
+    }
+    if (!writing) {
+        fs.setFileValid(type, false);
+        writing = true;
+    }
+    uint8_t b[8];
+    for (uint8_t k = 0; k < width; k++) {
+        b[k] = (uint32_t)key >> (8 * k);
+        b[width + k] = (uint32_t)value >> (8 * k);
+    }
+    invalidate();
+    return fs.writeAt(type, 2 + i * 2 * width, b, 2 * width, false);
+}
+
+bool EETable::commit(uint16_t count)
+{
+    uint8_t b[2];
+    if (count > capacity()) {
+        return false;
+    }
+    eep_put_u16(b, count);
+    if (!fs.writeAt(type, 0, b, sizeof(b))) {
+        return false;
+    }
+    fs.setFileValid(type, true);
+    writing = false;
+    entries = count;
+    invalidate();
+    return true;
+}
+
+// ============ 查询 ============
+uint16_t EETable::count(void) const
+{
+    return entries;
+}
+
+uint16_t EETable::capacity(void) const
+{
+    uint16_t size = fs.getFileMaxSize(type);
+    return (size < 2) ? 0 : (size - 2) / (2 * width);
+}
+
+uint32_t EETable::getDeviceReads() const
+{
+    return deviceReads;
+}
+
+uint32_t EETable::getCacheHits() const
+{
+    return cacheHits;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file eefile_table.h
+ * @brief 有序查找表文件类型：直接在存储上二分查找，可选线性插值
+ *
+ * 文件格式：[条目数 u16][键 0][值 0][键 1][值 1]...，键按升序排列，
+ * 键和值均为有符号整数，宽度 2 或 4 字节（小端）。
+ * lookup() 不把整张表读入 RAM，而是对存储二分查找（O(log n) 次条目读取），
+ * 读取经过一个很小的页缓存（EETABLE_CACHE_PAGES 页 x EETABLE_PAGE_SIZE 字节）；
+ * 并记住上次命中的区间，缓慢变化的输入（传感器读数）先检查该区间及其相邻区间，
+ * 命中时不再二分，通常也不再访问器件。
+ *
+ * 写表：put() 逐条写入（写入期间表标记为无效），commit() 写条目数并置有效。
+ *
+ * 用法：
+ *   EE_REG(CAL_CURVE, EETABLE_SIZE(200, 2));
+ *   EETable curve(CAL_CURVE, 2);
+ *   curve.begin();
+ *   int32_t mv;
+ *   if (curve.lookup(adc, &mv, true)) { ... }
+ */
+
+#ifndef __EEFILE_TABLE__
+#define __EEFILE_TABLE__
+
+#include "eefile.h"
+
+#ifndef EETABLE_CACHE_PAGES
+#define EETABLE_CACHE_PAGES 2
+#endif
+#ifndef EETABLE_PAGE_SIZE
+#define EETABLE_PAGE_SIZE 16
+#endif
+
+// 查找表文件注册大小：count 个条目，键/值宽度 width（2 或 4）字节
+#define EETABLE_SIZE(count, width) ((uint16_t)(2 + (count) * 2 * (width)))
+
+class EETable
+{
+  public:
+    /**
+     * @param type 已注册的文件类型，大小用 EETABLE_SIZE()
+     * @param width 键/值宽度：2（int16）或 4（int32）
+     */
+    EETable(EEFileType type, uint8_t width = 4, EEFILE& fs = EEFILE::getInstance());
+
+    /**
+     * @brief 读取条目数，须在文件注册之后调用
+     * @return 表有效且非空
+     */
+    bool begin(void);
+
+    /**
+     * @brief 查找 key 对应的值
+     * @param interpolate true：在相邻两点间线性插值，超出范围取端点值；
+     *                    false：只接受完全相等的键
+     * @return 找到（或插值成功）时返回 true
+     */
+    bool lookup(int32_t key, int32_t* value, bool interpolate = false);
+
+    /**
+     * @brief 读取第 i 个条目
+     */
+    bool entry(uint16_t i, int32_t* key, int32_t* value);
+
+    /**
+     * @brief 写入第 i 个条目（键须升序），首次调用时表标记为无效
+     */
+    bool put(uint16_t i, int32_t key, int32_t value);
+
+    /**
+     * @brief 写入条目数并把表标记为有效
+     */
+    bool commit(uint16_t count);
+
+    uint16_t count(void) const;
+    uint16_t capacity(void) const;
+    uint32_t getDeviceReads() const;    // 缓存未命中、读取器件的次数
+    uint32_t getCacheHits() const;
+
+  private:
+    EEFILE& fs;
+    EEFileType type;
+    uint8_t width;
+    uint16_t entries;
+    bool writing;
+    uint16_t hint;                      // 上次查找结果（第一个键 >= key 的条目）
+
+    uint8_t cache[EETABLE_CACHE_PAGES][EETABLE_PAGE_SIZE];
+    uint16_t cachePage[EETABLE_CACHE_PAGES];    // 0xFFFF 表示空
+    uint8_t cacheNext;                          // 轮换替换
+    uint32_t deviceReads;
+    uint32_t cacheHits;
+
+    uint8_t byteAt(uint16_t off);
+    int32_t intAt(uint16_t off);
+    int32_t keyAt(uint16_t i);
+    int32_t valueAt(uint16_t i);
+    void invalidate(void);
+    bool brackets(uint16_t i, int32_t key);
+};
+
+#endif
@@ -0,0 +1,256 @@
+/**
+ * @file eefile_tier.cpp
+ * @brief 分层存储后端实现
+ */
+
+#include "eefile_tier.h"
+
+EETierBackend::EETierBackend(EEBackend& slow, EEBackend& fast, uint16_t fastSize)
+    : slow(slow), fast(fast), fastSize(fastSize), fastNext(4), fastValid(false), mounted(false),
+      interval(EEFILE_TIER_CHECKPOINT_MS), lastCheckpoint(0),
+      checkpoints(0), slowBytes(0), restores(0)
+{
+    memset(regions, 0, sizeof(regions));
+}
+
+// ============ 挂载 ============
+// 快速层总头不符时重写总头；各热文件在 mapRegion() 中逐个检查、必要时恢复，
+// begin() 之前已映射的热文件在这里恢复
+void EETierBackend::begin()
+{
+    slow.begin();
+    fast.begin();
+
+    uint8_t head[4];
+    fast.readBlock(0, head, sizeof(head));
+    fastValid = (eep_get_u16(head) == EEFILE_TIER_MAGIC);
+    if (!fastValid) {
+        FILE_DEBUG("[EETIER] Fast tier blank, restoring from checkpoint");
+        eep_put_u16(head, EEFILE_TIER_MAGIC);
+        eep_put_u16(head + 2, 0xFFFF);
+        fast.writeBlock(0, head, sizeof(head));
+        fast.flush();
+    }
+    mounted = true;
+    for (uint8_t i = 0; i < EEFILE_TIER_REGIONS; i++) {
+        if (regions[i].len) {
+            restore(regions[i]);
+        }
+    }
+    lastCheckpoint = millis();
+}
+
+bool EETierBackend::mapRegion(uint8_t id, uint16_t addr, uint16_t len, uint8_t tier)
+{
+    // 主存储保存所有文件（热文件的检查点也在其中）
+    if (id >= EEFILE_TIER_REGIONS || !slow.mapRegion(id, addr, len, EEFILE_TIER_SLOW)) {
+        return false;
+    }
+    if (tier == EEFILE_TIER_SLOW) {
+        return true;
+    }
+    if (tier != EEFILE_TIER_FAST || 4 + len > fastSize - fastNext) {
+        FILE_DEBUG("[EETIER] ERROR: fast tier cannot hold region %d (%d bytes)", id, len);
+        return false;
+    }
+
+    Region& r = regions[id];
+    r.addr = addr;
+    r.len = len;
+    r.fastAddr = fastNext + 4;
+    r.dirty = false;
+    fastNext += 4 + len;
+    // 主存储与快速层在 begin() 之前不可访问，恢复推迟到 begin()
+    return mounted ? restore(r) : true;
+}
+
+// 快速层中该文件的头与当前布局一致则保留（比检查点更新），否则从主存储复制
+bool EETierBackend::restore(Region& r)
+{
+    uint8_t head[4];
+    fast.readBlock(r.fastAddr - 4, head, sizeof(head));
+    if (fastValid && eep_get_u16(head) == r.addr && eep_get_u16(head + 2) == r.len) {
+        r.dirty = true;                 // 上次检查点之后可能有改动
+        return true;
+    }
+
+    uint8_t buf[16];
+    for (uint16_t off = 0; off < r.len; off += sizeof(buf)) {
+        uint16_t n = r.len - off;
+        if (n > sizeof(buf)) {
+            n = sizeof(buf);
+        }
+        slow.readBlock(r.addr + off, buf, n);
+        fast.writeBlock(r.fastAddr + off, buf, n);
+    }
+    // 数据就位后再写头，复制中途掉电下次仍会重新恢复
+    eep_put_u16(head, r.addr);
+    eep_put_u16(head + 2, r.len);
+    fast.writeBlock(r.fastAddr - 4, head, sizeof(head));
+    fast.flush();
+    restores++;
+    return true;
+}
+
+// ============ 路由 ============
+int8_t EETierBackend::findHot(uint16_t addr) const
+{
+    for (uint8_t i = 0; i < EEFILE_TIER_REGIONS; i++) {
+        if (regions[i].len && addr >= regions[i].addr && addr - regions[i].addr < regions[i].len) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 从 addr 开始、同属一层的连续字节数；*hot 为热文件下标，冷数据为 -1
+uint16_t EETierBackend::span(uint16_t addr, uint16_t len, int8_t* hot) const
+{
+    *hot = findHot(addr);
+    if (*hot >= 0) {
+        const Region& r = regions[*hot];
+        uint16_t n = r.len - (addr - r.addr);
+        return (n < len) ? n : len;
+    }
+    uint16_t n = 1;
+    while (n < len && findHot(addr + n) < 0) {
+        n++;
+    }
+    return n;
+}
+
+uint8_t EETierBackend::read(uint16_t addr)
+{
+    int8_t h = findHot(addr);
+    return (h < 0) ? slow.read(addr) : fast.read(regions[h].fastAddr + addr - regions[h].addr);
+}
+
+void EETierBackend::write(uint16_t addr, uint8_t value)
+{
+    writeBlock(addr, &value, 1);
+}
+
+void EETierBackend::readBlock(uint16_t addr, uint8_t* buf, uint16_t len)
+{
+    while (len > 0) {
+        int8_t h;
+        uint16_t n = span(addr, len, &h);
+        if (h < 0) {
+            slow.readBlock(addr, buf, n);
+        } else {
+            fast.readBlock(regions[h].fastAddr + addr - regions[h].addr, buf, n);
+        }
+        buf += n;
+        addr += n;
+        len -= n;
+    }
+}
+
+void EETierBackend::writeBlock(uint16_t addr, const uint8_t* buf, uint16_t len)
+{
+    while (len > 0) {
+        int8_t h;
+        uint16_t n = span(addr, len, &h);
+        if (h < 0) {
+            slow.writeBlock(addr, buf, n);
+        } else {
+            fast.writeBlock(regions[h].fastAddr + addr - regions[h].addr, buf, n);
+            regions[h].dirty = true;
+        }
+        buf += n;
+        addr += n;
+        len -= n;
+    }
+}
+
+uint16_t EETierBackend::programUnit() const
+{
+    return slow.programUnit();
+}
+
+bool EETierBackend::coalesceWrites() const
+{
+    return slow.coalesceWrites();
+}
+
+void EETierBackend::flush()
+{
+    fast.flush();
+    slow.flush();
+    service();
+}
+
+void EETierBackend::service()
+{
+    if (interval && isDirty() && millis() - lastCheckpoint >= interval) {
+        checkpoint();
+    }
+}
+
+// ============ 检查点：只写回变化的字节 ============
+void EETierBackend::checkpoint(void)
+{
+    for (uint8_t i = 0; i < EEFILE_TIER_REGIONS; i++) {
+        Region& r = regions[i];
+        if (!r.len || !r.dirty) {
+            continue;
+        }
+        uint8_t cur[16];
+        uint8_t old[16];
+        for (uint16_t off = 0; off < r.len; off += sizeof(cur)) {
+            uint16_t n = r.len - off;
+            if (n > sizeof(cur)) {
+                n = sizeof(cur);
+            }
+            fast.readBlock(r.fastAddr + off, cur, n);
+            slow.readBlock(r.addr + off, old, n);
+            uint16_t lo = 0;
+            while (lo < n && cur[lo] == old[lo]) {
+                lo++;
+            }
+            if (lo == n) {
+                continue;
+            }
+            uint16_t hi = n;
+            while (cur[hi - 1] == old[hi - 1]) {
+                hi--;
+            }
+            slow.writeBlock(r.addr + off + lo, cur + lo, hi - lo);
+            slowBytes += hi - lo;
+        }
+        slow.flush();
+        r.dirty = false;
+    }
+    lastCheckpoint = millis();
+    checkpoints++;
+}
+
+void EETierBackend::setCheckpointInterval(uint32_t ms)
+{
+    interval = ms;
+}
+
+bool EETierBackend::isDirty(void) const
+{
+    for (uint8_t i = 0; i < EEFILE_TIER_REGIONS; i++) {
+        if (regions[i].len && regions[i].dirty) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint16_t EETierBackend::getCheckpointCount() const
+{
+    return checkpoints;
+}
+
+uint32_t EETierBackend::getSlowBytes() const
+{
+    return slowBytes;
+}
+
+uint16_t EETierBackend::getRestoreCount() const
+{
+    return restores;
+}
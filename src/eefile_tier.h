@@ -0,0 +1,100 @@
+/**
+ * @file eefile_tier.h
+ * @brief 分层存储后端：热文件放在快速层，定期检查点到主存储
+ *
+ * 注册时用 EE_REG_TIER(type, size, EEFILE_TIER_FAST) 把频繁改写的文件放到
+ * 快速层（掉电保持 RAM、RTC 保持内存、FRAM 等，见 EERamBackend），其它文件
+ * 仍在主存储。EE_READ / EE_WRITE 不变，由本后端按地址路由：
+ *   - 热文件的读写只访问快速层，并标记为脏
+ *   - checkpoint() 把脏的热文件差异写回主存储（只写变化的字节）
+ *   - flush() / service() 时若距上次检查点超过间隔，自动做一次检查点；
+ *     只写一次就不再改写的热文件要靠 service()（EE.service() 会调用）到期写回
+ *
+ * 调用顺序：EE.begin() 先调用本后端的 begin()，之后注册的热文件在 mapRegion()
+ * 中立即恢复；begin() 之前注册的热文件推迟到 begin() 中恢复。
+ *
+ * 快速层布局：[magic u16][保留 u16]，之后每个热文件 [地址 u16][长度 u16][数据]。
+ * 挂载时 magic 或某个文件的头不符（RAM 内容丢失、布局改变），该文件从主存储
+ * 的最近检查点恢复。
+ */
+
+#ifndef __EEFILE_TIER__
+#define __EEFILE_TIER__
+
+#include "eefile.h"
+
+#define EEFILE_TIER_MAGIC       0x5445      // "ET"
+#define EEFILE_TIER_REGIONS     (EEFILE_MAX_FILES + 1)      // 文件 + 有效位图
+
+// 自动检查点间隔（毫秒），0 表示只在调用 checkpoint() 时写回
+#ifndef EEFILE_TIER_CHECKPOINT_MS
+#define EEFILE_TIER_CHECKPOINT_MS 60000UL
+#endif
+
+// 快速层容量：热文件总大小 + 每个热文件 4 字节头 + 4 字节总头
+#define EEFILE_TIER_FAST_SIZE(hotBytes, hotFiles) ((hotBytes) + 4 * (hotFiles) + 4)
+
+class EETierBackend : public EEBackend
+{
+  public:
+    /**
+     * @param slow 主存储后端（EEPROM / Flash），保存所有文件及热文件的检查点
+     * @param fast 快速层后端
+     * @param fastSize 快速层可用字节数
+     */
+    EETierBackend(EEBackend& slow, EEBackend& fast, uint16_t fastSize);
+
+    void begin();
+    uint8_t read(uint16_t addr);
+    void write(uint16_t addr, uint8_t value);
+    void readBlock(uint16_t addr, uint8_t* buf, uint16_t len);
+    void writeBlock(uint16_t addr, const uint8_t* buf, uint16_t len);
+    uint16_t programUnit() const;
+    bool coalesceWrites() const;
+    bool mapRegion(uint8_t id, uint16_t addr, uint16_t len, uint8_t tier);
+    void flush();
+
+    /**
+     * @brief 距上次检查点超过间隔且有脏的热文件时做一次检查点，在主循环中调用
+     */
+    void service();
+
+    /**
+     * @brief 把脏的热文件写回主存储（掉电检测、休眠前也应调用）
+     */
+    void checkpoint(void);
+    void setCheckpointInterval(uint32_t ms);
+    bool isDirty(void) const;
+
+    uint16_t getCheckpointCount() const;    // 检查点次数
+    uint32_t getSlowBytes() const;          // 检查点写回主存储的字节数
+    uint16_t getRestoreCount() const;       // 挂载时从主存储恢复的热文件数
+
+  private:
+    typedef struct {
+        uint16_t addr;
+        uint16_t len;                   // 0 表示不是热文件
+        uint16_t fastAddr;              // 快速层中数据的起始地址
+        bool dirty;
+    } Region;
+
+    EEBackend& slow;
+    EEBackend& fast;
+    uint16_t fastSize;
+    uint16_t fastNext;
+    bool fastValid;
+    bool mounted;                       // begin() 已调用，主存储与快速层可以访问
+
+    Region regions[EEFILE_TIER_REGIONS];
+    uint32_t interval;
+    uint32_t lastCheckpoint;
+    uint16_t checkpoints;
+    uint32_t slowBytes;
+    uint16_t restores;
+
+    int8_t findHot(uint16_t addr) const;
+    uint16_t span(uint16_t addr, uint16_t len, int8_t* hot) const;
+    bool restore(Region& r);
+};
+
+#endif
@@ -0,0 +1,105 @@
+/**
+ * @file eefile_wom.h
+ * @brief 一次写入存储器（WOM）编码：Rivest–Shamir <2 位数据 / 3 个存储位>
+ *
+ * 存储位擦除态为 1，只能从 1 编程为 0（NOR Flash 的特性）。每个 2 位符号占 3 个
+ * 存储位，擦除一次可以写两代：
+ *   第一代（清零 ≤1 位）：00->111  01->011  10->101  11->110
+ *   第二代（清零 ≥2 位）：第一代码字按位取反
+ * 任意第一代码字都可以只清零位改写成另一个值的第二代码字。
+ *
+ * 一个值占一个“槽”：每字节放两个符号（bit0-2、bit4-6），第一个字节的 bit3
+ * 清零表示该槽已启用。槽写满两代后换下一个槽，所有槽用完才需要擦除。
+ * 本文件只依赖 stdint.h，设备端与主机工具共用。
+ */
+
+#ifndef __EEFILE_WOM__
+#define __EEFILE_WOM__
+
+#include <stdint.h>
+
+#define EEW_SYMBOLS(bits)       (((bits) + 1) / 2)
+#define EEW_SLOT_BYTES(bits)    ((EEW_SYMBOLS(bits) + 1) / 2)
+#define EEW_SLOT_USED           0x08        // 第一个字节中的启用位（清零 = 启用）
+#define EEW_MAX_BITS            16
+
+// 注册 WOM 文件所需的大小：bits 位的值，slots 个槽
+#define EEFILE_WOM_SIZE(bits, slots)    (EEW_SLOT_BYTES(bits) * (slots))
+
+// 以下 c 均为 3 位“已清零位”掩码（1 = 已编程为 0）
+static inline uint8_t eew_weight(uint8_t c)
+{
+    return (c & 1) + ((c >> 1) & 1) + ((c >> 2) & 1);
+}
+
+static inline uint8_t eew_gen1(uint8_t sym)
+{
+    return sym ? (uint8_t)(1 << (3 - sym)) : 0;
+}
+
+static inline uint8_t eew_decode(uint8_t c)
+{
+    if (eew_weight(c) >= 2) {
+        c = ~c & 7;
+    }
+    return (c == 4) ? 1 : (c == 2) ? 2 : (c == 1) ? 3 : 0;
+}
+
+// 在 c 上写入 sym 后的掩码；只清零位无法做到时返回 0xFF
+static inline uint8_t eew_next(uint8_t c, uint8_t sym)
+{
+    if (eew_decode(c) == sym) {
+        return c;
+    }
+    if (c == 0) {
+        return eew_gen1(sym);
+    }
+    if (eew_weight(c) == 1) {
+        return ~eew_gen1(sym) & 7;
+    }
+    return 0xFF;
+}
+
+static inline bool eew_slot_used(const uint8_t* slot)
+{
+    return (slot[0] & EEW_SLOT_USED) == 0;
+}
+
+static inline uint16_t eew_decode_slot(const uint8_t* slot, uint8_t bits)
+{
+    uint16_t v = 0;
+    for (uint8_t i = 0; i < EEW_SYMBOLS(bits); i++) {
+        uint8_t c = (uint8_t)(~slot[i >> 1] >> ((i & 1) * 4)) & 7;
+        v |= (uint16_t)eew_decode(c) << (i * 2);
+    }
+    return (bits < 16) ? (uint16_t)(v & ((1u << bits) - 1)) : v;
+}
+
+/**
+ * @brief 尝试在槽内就地写入 value（只清零位）
+ * @param slot 槽的当前内容，成功时更新为新内容
+ * @return 成功返回 true；需要换槽时返回 false，slot 不变
+ */
+static inline bool eew_encode_slot(uint8_t* slot, uint8_t bits, uint16_t value)
+{
+    uint8_t out[EEW_SLOT_BYTES(EEW_MAX_BITS)];
+    for (uint8_t i = 0; i < EEW_SLOT_BYTES(bits); i++) {
+        out[i] = slot[i];
+    }
+    for (uint8_t i = 0; i < EEW_SYMBOLS(bits); i++) {
+        uint8_t shift = (i & 1) * 4;
+        uint8_t c = (uint8_t)(~slot[i >> 1] >> shift) & 7;
+        uint8_t n = eew_next(c, (value >> (i * 2)) & 3);
+        if (n == 0xFF) {
+            return false;
+        }
+        out[i >> 1] &= (uint8_t)~(n << shift);
+    }
+    out[0] &= (uint8_t)~EEW_SLOT_USED;
+    for (uint8_t i = 0; i < EEW_SLOT_BYTES(bits); i++) {
+        slot[i] = out[i];
+    }
+    return true;
+}
+
+#endif